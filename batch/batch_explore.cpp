@@ -0,0 +1,293 @@
+#include "../include/Simulation.hpp"
+#include "../include/Map.hpp"
+#include "../include/ThreadPool.hpp"
+#include "../include/CommandLine.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <chrono>
+
+// =========================================================
+// LOTS D'ÉPISODES D'EXPLORATION
+// =========================================================
+// Lance N simulations indépendantes sans affichage (une par épisode), réparties sur tous les
+// cœurs, et écrit le résultat de chaque épisode en CSV et/ou JSON : ticks jusqu'à la fin de
+// l'exploration, distance parcourue, courbe d'exploration.
+//
+// Chaque épisode a sa graine (graine de base + numéro de l'épisode, donc une position de
+// départ différente) et sa carte (les cartes données sont utilisées à tour de rôle). Chaque carte
+// n'est chargée qu'une fois : toutes les simulations de cette carte partagent ses données
+// (bitmap, champ de distance, pyramide), en lecture seule.
+//
+// Les épisodes sont distribués un par un aux threads du ThreadPool (parallelFor par blocs de 1) :
+// un thread libre prend l'épisode suivant, les épisodes longs ne retardent donc pas les autres.
+// Chaque simulation calcule son Lidar en série (pas de threads dans les threads).
+//
+// Utilisation : ./batch_explore --episodes 200 --map ../Images/map.png --csv resultats.csv
+
+// Options du lot
+struct BatchOptions {
+    int episodes = 16;                // Nombre d'épisodes
+    std::vector<std::string> maps;    // Cartes utilisées à tour de rôle (map.png par défaut)
+    unsigned seed = 1;                // Graine du premier épisode (les suivants : seed + i)
+    int maxTicks = 20000;             // Ticks maximum par épisode
+    int arucoId = 1;                  // Tag "vu" au tick 0 (1 : suivi de mur)
+    int coverageInterval = 100;       // Un point de la courbe d'exploration tous les N ticks
+    int threads = 0;                  // Épisodes en parallèle (0 : un par cœur)
+    std::string csvPath;              // Fichier CSV (vide : pas de CSV)
+    std::string jsonPath;             // Fichier JSON (vide : pas de JSON)
+};
+
+// Résultat d'un épisode
+struct EpisodeResult {
+    int mapIndex;
+    unsigned seed;
+    int ticks;                        // Ticks exécutés
+    int exploredTick;                 // Tick de fin d'exploration (-1 : pas atteinte)
+    double pathLength;                // Distance parcourue (pixels)
+    double finalCoverage;             // Part explorée à la fin de l'épisode
+    std::vector<double> coverage;     // Part explorée tous les coverageInterval ticks
+    double seconds;                   // Temps de calcul de l'épisode
+};
+
+static void printUsage(const char* program) {
+    std::cout << "Utilisation : " << program << " [options]\n"
+              << "  --episodes <n>      Nombre d'episodes (defaut : 16)\n"
+              << "  --map <fichier>     Carte (option repetable, utilisees a tour de role)\n"
+              << "  --seed <n>          Graine du premier episode, > 0 (defaut : 1)\n"
+              << "  --ticks <n>         Ticks maximum par episode (defaut : 20000)\n"
+              << "  --aruco <id>        Tag vu au depart (defaut : 1, suivi de mur)\n"
+              << "  --coverage-every <n> Pas de la courbe d'exploration en ticks (defaut : 100)\n"
+              << "  --threads <n>       Episodes en parallele (defaut : 0, un par coeur)\n"
+              << "  --csv <fichier>     Resultats en CSV\n"
+              << "  --json <fichier>    Resultats en JSON" << std::endl;
+}
+
+static bool parseArguments(int argc, char** argv, BatchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            return false;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "ERREUR : option inconnue ou incomplete \"" << arg << "\"." << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        int number = 0;
+        bool ok = true;
+        if (arg == "--map") {
+            options.maps.push_back(value);
+        } else if (arg == "--csv") {
+            options.csvPath = value;
+        } else if (arg == "--json") {
+            options.jsonPath = value;
+        } else if (arg == "--seed") {
+            // Graine 0 : tirée au hasard par Simulation, l'épisode 0 ne serait pas reproductible
+            if (!parseSeed(value, options.seed)) {
+                std::cerr << "ERREUR : --seed attend un nombre de 1 a 4294967295." << std::endl;
+                return false;
+            }
+        } else if (arg == "--episodes" || arg == "--ticks" || arg == "--aruco" ||
+                   arg == "--coverage-every" || arg == "--threads") {
+            ok = parseCount(value, number);
+            if (arg == "--episodes") options.episodes = number;
+            else if (arg == "--ticks") options.maxTicks = number;
+            else if (arg == "--aruco") options.arucoId = number;
+            else if (arg == "--coverage-every") options.coverageInterval = number;
+            else options.threads = number;
+        } else {
+            std::cerr << "ERREUR : option inconnue \"" << arg << "\"." << std::endl;
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "ERREUR : " << arg << " attend un nombre, pas \"" << value << "\"." << std::endl;
+            return false;
+        }
+    }
+    if (options.episodes == 0 || options.maxTicks == 0) {
+        std::cerr << "ERREUR : --episodes et --ticks doivent etre > 0." << std::endl;
+        return false;
+    }
+    // Graines seed, seed + 1... : la dernière ne doit pas repasser par 0 (tirée au hasard)
+    if (options.seed - 1 > UINT32_MAX - static_cast<unsigned>(options.episodes)) {
+        std::cerr << "ERREUR : --seed + --episodes depasse 4294967296." << std::endl;
+        return false;
+    }
+    if (options.maps.empty()) {
+        options.maps.push_back("map.png");
+    }
+    if (options.csvPath.empty() && options.jsonPath.empty()) {
+        options.csvPath = "batch_results.csv";
+    }
+    return true;
+}
+
+// Chaîne JSON (guillemets et antislashs échappés, caractères de contrôle en \n, \t... ou \u00XX)
+static std::string jsonString(const std::string& text) {
+    static const char* hex = "0123456789abcdef";
+    std::string out = "\"";
+    for (char c : text) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (c == '\n') {
+            out += "\\n";
+        } else if (c == '\r') {
+            out += "\\r";
+        } else if (c == '\t') {
+            out += "\\t";
+        } else if (u < 0x20) {
+            out += "\\u00";
+            out += hex[u >> 4];
+            out += hex[u & 0xF];
+        } else {
+            out += c;
+        }
+    }
+    return out + "\"";
+}
+
+// Champ CSV entre guillemets (guillemets doublés) : un chemin peut contenir ',' ou '"'
+static std::string csvString(const std::string& text) {
+    std::string out = "\"";
+    for (char c : text) {
+        if (c == '"') out += '"';
+        out += c;
+    }
+    return out + "\"";
+}
+
+// =========================================================
+// ÉCRITURE DES RÉSULTATS
+// =========================================================
+static bool writeCsv(const std::string& path, const BatchOptions& options, const std::vector<EpisodeResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "ERREUR : Impossible de creer '" << path << "'." << std::endl;
+        return false;
+    }
+    // La courbe d'exploration tient dans une colonne (valeurs séparées par des ';')
+    out << "episode,map,seed,ticks,explored_tick,path_length,final_coverage,seconds,coverage\n";
+    out << std::fixed;
+    for (size_t i = 0; i < results.size(); i++) {
+        const EpisodeResult& r = results[i];
+        out << i << ',' << csvString(options.maps[r.mapIndex]) << ',' << r.seed << ',' << r.ticks << ','
+            << r.exploredTick << ',' << std::setprecision(1) << r.pathLength << ','
+            << std::setprecision(4) << r.finalCoverage << ','
+            << r.seconds << ',';
+        for (size_t k = 0; k < r.coverage.size(); k++) {
+            out << (k ? ";" : "") << r.coverage[k];
+        }
+        out << '\n';
+    }
+    return true;
+}
+
+static bool writeJson(const std::string& path, const BatchOptions& options, const std::vector<EpisodeResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "ERREUR : Impossible de creer '" << path << "'." << std::endl;
+        return false;
+    }
+    out << std::fixed << "{\n  \"coverage_interval\": " << options.coverageInterval
+        << ",\n  \"max_ticks\": " << options.maxTicks << ",\n  \"episodes\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const EpisodeResult& r = results[i];
+        out << "    {\"episode\": " << i << ", \"map\": " << jsonString(options.maps[r.mapIndex])
+            << ", \"seed\": " << r.seed << ", \"ticks\": " << r.ticks
+            << ", \"explored_tick\": " << r.exploredTick
+            << ", \"path_length\": " << std::setprecision(1) << r.pathLength
+            << ", \"final_coverage\": " << std::setprecision(4) << r.finalCoverage
+            << ", \"seconds\": " << std::setprecision(4) << r.seconds << ", \"coverage\": [";
+        for (size_t k = 0; k < r.coverage.size(); k++) {
+            out << (k ? ", " : "") << r.coverage[k];
+        }
+        out << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+    return true;
+}
+
+// =========================================================
+// POINT D'ENTRÉE
+// =========================================================
+int main(int argc, char** argv) {
+    BatchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    // Chaque carte est chargée une seule fois, puis partagée par toutes ses simulations
+    std::vector<std::shared_ptr<const Map>> maps;
+    for (const std::string& path : options.maps) {
+        maps.push_back(std::make_shared<const Map>(path));
+    }
+
+    ThreadPool pool(options.threads);
+    std::cout << options.episodes << " episodes sur " << maps.size() << " carte(s), "
+              << pool.getThreadCount() << " thread(s)" << std::endl;
+
+    std::vector<EpisodeResult> results(options.episodes);
+    std::mutex progressMutex;
+    int finished = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    pool.parallelFor(options.episodes, 1, [&](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            auto episodeStart = std::chrono::steady_clock::now();
+
+            SimulationOptions simOptions;
+            simOptions.map = maps[i % maps.size()];
+            simOptions.headless = true;
+            simOptions.verbose = false;
+            simOptions.threads = 1;
+            simOptions.seed = options.seed + static_cast<unsigned>(i);
+            simOptions.maxTicks = options.maxTicks;
+            simOptions.untilExplored = true;
+            simOptions.coverageInterval = options.coverageInterval;
+            simOptions.events.push_back({0, -1, options.arucoId});
+
+            Simulation sim(simOptions);
+            sim.run();
+
+            EpisodeResult& r = results[i];
+            r.mapIndex = i % static_cast<int>(maps.size());
+            r.seed = simOptions.seed;
+            r.ticks = sim.getTickCount();
+            r.exploredTick = sim.getExploredTick();
+            r.pathLength = sim.getPathLength();
+            r.finalCoverage = 1.0 - sim.getOccupancyGrid().getUnknownRatio();
+            r.coverage = sim.getCoverageCurve();
+            r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - episodeStart).count();
+
+            std::lock_guard<std::mutex> lock(progressMutex);
+            finished++;
+            std::cout << "\rEpisodes termines : " << finished << "/" << options.episodes << std::flush;
+        }
+    });
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Bilan : le temps cumulé des épisodes divisé par le temps réel donne l'accélération obtenue
+    double episodeSeconds = 0.0;
+    int explored = 0;
+    for (const EpisodeResult& r : results) {
+        episodeSeconds += r.seconds;
+        if (r.exploredTick >= 0) explored++;
+    }
+    std::cout << "\n" << explored << "/" << options.episodes << " explorations terminees en "
+              << std::fixed << std::setprecision(2) << wallSeconds << " s ("
+              << options.episodes / wallSeconds << " episodes/s, acceleration x"
+              << (wallSeconds > 0.0 ? episodeSeconds / wallSeconds : 0.0) << ")" << std::endl;
+
+    bool ok = true;
+    if (!options.csvPath.empty()) ok = writeCsv(options.csvPath, options, results) && ok;
+    if (!options.jsonPath.empty()) ok = writeJson(options.jsonPath, options, results) && ok;
+    return ok ? 0 : 1;
+}
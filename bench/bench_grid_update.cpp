@@ -0,0 +1,375 @@
+#include "../include/Map.hpp"
+#include "../include/Robot.hpp"
+#include "../include/Lidar.hpp"
+#include "../include/OccupancyGrid.hpp"
+#include "../include/RayStencil.hpp"
+#include "../include/PackedTriStateGrid.hpp"
+#include "../include/OccupancySnapshot.hpp"
+#include "../include/OccupancyLog.hpp"
+#include <cstdio>
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+
+// =========================================================
+// BENCHMARK : MISE À JOUR DE LA GRILLE D'OCCUPATION
+// =========================================================
+// Compare, pour les mêmes scans, le tracé de lignes d'origine (Bresenham jusqu'à chaque impact)
+// avec le pochoir des rayons (RayStencil : chaque case libre écrite une seule fois par scan),
+// et mesure aussi la mise à jour fusionnée avec le lancer de rayons (Lidar::scanAndMap()),
+// sur une grille binaire et sur une grille probabiliste (mode LOG_ODDS), puis avec un
+// instantané publié après chaque scan (copie sur écriture des tuiles, voir OccupancySnapshot),
+// et avec chaque scan ajouté au journal de la grille (OccupancyLog : images clés et changements).
+// Affiche le nombre de cases écrites par scan et le temps par scan, puis la mémoire des tuiles
+// allouées par la grille après tous les scans (comparée à une grille dense de la carte), et le
+// comptage des cases inconnues de toute la carte : octet par octet, puis par popcount sur la
+// copie compacte (PackedTriStateGrid, 2 bits par case), et enfin des requêtes de zone
+// ("une case inconnue ?", "tout libre ?") : parcours des cases, puis pyramide multi-résolution.
+//
+// Utilisation : ./bench_grid_update [chemin/vers/map.png]
+
+// Nombre de positions de test et nombre de répétitions de la mesure
+static const int NUM_POSITIONS = 200;
+static const int NUM_REPEATS = 5;
+
+// Tire des positions libres au hasard (graine fixe, comme bench_raycast)
+static std::vector<cv::Point> samplePositions(const Map& map, int count) {
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<> distX(0, map.getWidth() - 1);
+    std::uniform_int_distribution<> distY(0, map.getHeight() - 1);
+
+    std::vector<cv::Point> positions;
+    int attempts = 0;
+    while (static_cast<int>(positions.size()) < count && attempts < 100000) {
+        attempts++;
+        cv::Point p(distX(gen), distY(gen));
+        if (map.getClearance(p.x, p.y) > 5.0f) {
+            positions.push_back(p);
+        }
+    }
+    return positions;
+}
+
+// Les 4 orientations possibles du robot (droite, bas, gauche, haut)
+static const int DIRS[4][2] = { {1, 0}, {0, 1}, {-1, 0}, {0, -1} };
+
+// Résultat d'une méthode de mise à jour
+struct UpdateResult {
+    double cellsPerScan; // Cases écrites par scan (0 si non mesuré)
+    double usPerScan;    // Temps moyen par scan (microsecondes)
+};
+
+// Temps écoulé entre deux instants, en microsecondes
+static double elapsedUs(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration<double, std::micro>(end - start).count();
+}
+
+// Place le robot à chaque position, dans les 4 orientations, NUM_REPEATS fois, et appelle
+// step() à chaque pose ; retourne le temps moyen par pose (microsecondes)
+template <typename Step>
+static double timePoses(Robot& robot, const std::vector<cv::Point>& positions, Step step) {
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < NUM_REPEATS; rep++) {
+        for (const cv::Point& p : positions) {
+            robot.setPosition(p);
+            for (const auto& d : DIRS) {
+                robot.updateOrientation(d[0], d[1]);
+                step();
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return elapsedUs(start, end) / (static_cast<double>(NUM_REPEATS) * positions.size() * 4);
+}
+
+// Mise à jour par tracé de lignes (méthode d'origine), sur des scans déjà calculés
+static UpdateResult benchLines(const Map& map, const std::vector<LidarScan>& scans) {
+    OccupancyGrid grid(map.getWidth(), map.getHeight());
+    long long cells = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < NUM_REPEATS; rep++) {
+        for (const LidarScan& scan : scans) {
+            grid.update(scan.hitPoints, scan.origin);
+            cells += grid.getLastUpdateCellCount();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double totalScans = static_cast<double>(NUM_REPEATS) * scans.size();
+    return { cells / totalScans, elapsedUs(start, end) / totalScans };
+}
+
+// Mise à jour par le pochoir des rayons, sur les mêmes scans
+static UpdateResult benchStencil(const Map& map, const Lidar& lidar, const std::vector<LidarScan>& scans) {
+    OccupancyGrid grid(map.getWidth(), map.getHeight());
+    grid.useRayStencil(lidar);
+    long long cells = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < NUM_REPEATS; rep++) {
+        for (const LidarScan& scan : scans) {
+            grid.update(scan);
+            cells += grid.getLastUpdateCellCount();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    const double totalScans = static_cast<double>(NUM_REPEATS) * scans.size();
+    return { cells / totalScans, elapsedUs(start, end) / totalScans };
+}
+
+// Lancer de rayons seul (pour comparaison avec scanAndMap())
+static double benchScanOnly(Lidar& lidar, Robot& robot, const std::vector<cv::Point>& positions) {
+    LidarScan scan;
+    return timePoses(robot, positions, [&] { lidar.scan(scan); });
+}
+
+// Lancer de rayons + mise à jour fusionnés (Lidar::scanAndMap()), dans la grille fournie
+static double benchScanAndMap(Lidar& lidar, Robot& robot, const std::vector<cv::Point>& positions, OccupancyGrid& grid) {
+    LidarScan scan;
+    return timePoses(robot, positions, [&] { lidar.scanAndMap(scan, grid); });
+}
+
+// scanAndMap() suivi d'un instantané publié après chaque scan (comme pour un lecteur sur un autre
+// thread) : chaque tuile modifiée par le scan est copiée une fois. copiedTiles : tuiles copiées
+static double benchSnapshots(const Map& map, Lidar& lidar, Robot& robot, const std::vector<cv::Point>& positions,
+                             int& copiedTiles) {
+    OccupancyGrid grid(map.getWidth(), map.getHeight());
+    LidarScan scan;
+    double us = timePoses(robot, positions, [&] {
+        lidar.scanAndMap(scan, grid);
+        grid.publishSnapshot();
+    });
+    copiedTiles = grid.getCopiedTileCount();
+    return us;
+}
+
+// Résultat du journal de la grille
+struct LogResult {
+    double usPerScan = 0.0; // scanAndMap() + ajout au journal, par scan (microsecondes)
+    size_t bytes = 0;       // Taille du journal
+    double seekUs = 0.0;    // Relecture d'un tick au hasard (microsecondes)
+};
+
+// scanAndMap() suivi de l'ajout de chaque scan au journal (fichier temporaire, supprimé ensuite),
+// puis relecture de ticks au hasard (graine fixe), depuis l'image clé la plus proche
+static LogResult benchLog(const Map& map, Lidar& lidar, Robot& robot, const std::vector<cv::Point>& positions) {
+    const std::string logPath = "bench_grid_update.ogl";
+    LogResult result;
+    OccupancyGrid grid(map.getWidth(), map.getHeight());
+    OccupancyLogWriter logWriter;
+    if (!logWriter.open(logPath)) {
+        return result;
+    }
+    LidarScan scan;
+    result.usPerScan = timePoses(robot, positions, [&] {
+        lidar.scanAndMap(scan, grid);
+        logWriter.writeTick(grid);
+    });
+    logWriter.close();
+    result.bytes = logWriter.getBytesWritten();
+
+    OccupancyLogReader logReader;
+    if (logReader.open(logPath) && logReader.getTickCount() > 0) {
+        std::mt19937 seekGen(777);
+        const int seeks = 200;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < seeks; i++) {
+            logReader.seek(static_cast<int>(seekGen() % logReader.getTickCount()));
+        }
+        auto end = std::chrono::steady_clock::now();
+        result.seekUs = elapsedUs(start, end) / seeks;
+    }
+    std::remove(logPath.c_str());
+    return result;
+}
+
+// Comptage des cases inconnues de toute la grille : 8 bits par case (bytesUs), puis 2 bits
+// par popcount sur la copie compacte (packedUs, packedBytes : sa taille)
+static void benchCountUnknown(const OccupancyGrid& grid, double& bytesUs, double& packedUs, size_t& packedBytes) {
+    cv::Mat cells = grid.getGrid();
+    PackedTriStateGrid packed;
+    grid.toPacked(packed);
+    packedBytes = packed.getMemoryBytes();
+
+    const int countRepeats = 100;
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < countRepeats; rep++) {
+        int unknown = 0;
+        for (int y = 0; y < cells.rows; y++) {
+            const uchar* row = cells.ptr<uchar>(y);
+            for (int x = 0; x < cells.cols; x++) {
+                unknown += (row[x] == 127);
+            }
+        }
+        sink = unknown;
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < countRepeats; rep++) {
+        sink = packed.countUnknown();
+    }
+    auto end = std::chrono::steady_clock::now();
+    (void)sink;
+    bytesUs = elapsedUs(start, mid) / countRepeats;
+    packedUs = elapsedUs(mid, end) / countRepeats;
+}
+
+// Requêtes de zone ("une case inconnue ?", "tout libre ?") sur des fenêtres au hasard (graine
+// fixe) : parcours des cases (scanUs), puis pyramide multi-résolution (pyramidUs)
+static void benchRegionQueries(const OccupancyGrid& grid, double& scanUs, double& pyramidUs) {
+    cv::Mat cells = grid.getGrid();
+    std::mt19937 gen(54321);
+    std::vector<cv::Rect> windows;
+    for (int i = 0; i < 1000; i++) {
+        const int size = 16 << (i % 4); // Fenêtres de 16 à 128 cases de côté
+        windows.push_back(cv::Rect(static_cast<int>(gen() % cells.cols), static_cast<int>(gen() % cells.rows), size, size)
+                          & cv::Rect(0, 0, cells.cols, cells.rows));
+    }
+
+    int scanAnswers = 0;
+    int pyramidAnswers = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (const cv::Rect& window : windows) {
+        bool unknown = false;
+        bool allFree = true;
+        for (int y = window.y; y < window.y + window.height && !unknown; y++) {
+            const uchar* row = cells.ptr<uchar>(y);
+            for (int x = window.x; x < window.x + window.width; x++) {
+                unknown = unknown || (row[x] == 127);
+                allFree = allFree && (row[x] == 255);
+            }
+        }
+        scanAnswers += unknown + allFree;
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (const cv::Rect& window : windows) {
+        pyramidAnswers += grid.hasUnknown(window) + grid.isRegionFree(window);
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (scanAnswers != pyramidAnswers) {
+        std::cerr << "Requetes de zone : resultats differents !" << std::endl;
+    }
+    scanUs = elapsedUs(start, mid) / windows.size();
+    pyramidUs = elapsedUs(mid, end) / windows.size();
+}
+
+// Affiche une ligne du tableau des méthodes (cellsPerScan < 0 : non mesuré)
+static void printRow(const std::string& label, double cellsPerScan, double usPerScan) {
+    std::cout << std::left << std::setw(26) << label << std::right << std::setw(14);
+    if (cellsPerScan < 0.0) {
+        std::cout << "-";
+    } else {
+        std::cout << cellsPerScan;
+    }
+    std::cout << std::setw(14) << usPerScan << std::endl;
+}
+
+// Mesure une configuration du capteur sur toutes les positions et les 4 orientations
+static void benchConfig(const Map& map, const std::vector<cv::Point>& positions, const LidarConfig& config) {
+    Robot robot(cv::Point(0, 0), 11);
+    Lidar lidar(&map, &robot, config);
+
+    // Scans calculés une fois : seules les mises à jour de la grille sont chronométrées
+    std::vector<LidarScan> scans;
+    scans.reserve(positions.size() * 4);
+    for (const cv::Point& p : positions) {
+        robot.setPosition(p);
+        for (const auto& d : DIRS) {
+            robot.updateOrientation(d[0], d[1]);
+            LidarScan scan;
+            lidar.scan(scan);
+            scans.push_back(scan);
+        }
+    }
+    const int totalScans = NUM_REPEATS * static_cast<int>(scans.size());
+
+    UpdateResult lines = benchLines(map, scans);
+    UpdateResult stencil = benchStencil(map, lidar, scans);
+    RayStencil info;
+    lidar.buildRayStencil(info);
+
+    // Grille binaire remplie par scanAndMap() : aussi celle des comptages et des requêtes de zone
+    OccupancyGrid grid(map.getWidth(), map.getHeight());
+    double fusedUs = benchScanAndMap(lidar, robot, positions, grid);
+    OccupancyGrid probGrid(map.getWidth(), map.getHeight());
+    probGrid.setMode(OccupancyMode::LOG_ODDS);
+    double fusedLogOddsUs = benchScanAndMap(lidar, robot, positions, probGrid);
+    double scanUs = benchScanOnly(lidar, robot, positions);
+    int copiedTiles = 0;
+    double snapshotUs = benchSnapshots(map, lidar, robot, positions, copiedTiles);
+    LogResult log = benchLog(map, lidar, robot, positions);
+
+    double countBytesUs = 0.0, countPackedUs = 0.0;
+    size_t packedBytes = 0;
+    benchCountUnknown(grid, countBytesUs, countPackedUs, packedBytes);
+    double regionScanUs = 0.0, regionPyramidUs = 0.0;
+    benchRegionQueries(grid, regionScanUs, regionPyramidUs);
+
+    std::cout << "\n--- " << config.numRays << " rayons, portee " << config.maxRange << " px ---" << std::endl;
+    std::cout << "Pochoir : " << info.getPathCellCount() << " cases sur l'ensemble des rayons, "
+              << info.getNodeCount() << " apres fusion des debuts communs, " << info.getCellCount()
+              << " cases distinctes" << std::endl;
+    std::cout << std::left << std::setw(26) << "Methode"
+              << std::right << std::setw(14) << "cases/scan"
+              << std::setw(14) << "us/scan" << std::endl;
+
+    std::cout << std::fixed << std::setprecision(1);
+    printRow("Traces de lignes", lines.cellsPerScan, lines.usPerScan);
+    printRow("RayStencil", stencil.cellsPerScan, stencil.usPerScan);
+    printRow("scan() seul", -1.0, scanUs);
+    printRow("scanAndMap() (fusionne)", -1.0, fusedUs);
+    printRow("scanAndMap() (LOG_ODDS)", -1.0, fusedLogOddsUs);
+    printRow("scanAndMap() + instantane", -1.0, snapshotUs);
+    printRow("scanAndMap() + journal", -1.0, log.usPerScan);
+    std::cout << "Tuiles copiees pour les instantanes : " << copiedTiles << " (pour " << totalScans << " scans)" << std::endl;
+
+    // Un résultat négatif est possible : le DDA (4-connexe) traverse plus de cases qu'une ligne
+    // 8-connexe, et le tracé de lignes ignore les rayons dont l'impact sort de la grille
+    double saved = 100.0 * (lines.cellsPerScan - stencil.cellsPerScan) / lines.cellsPerScan;
+    std::cout << "Journal : " << log.bytes / 1024 << " Ko pour " << totalScans << " ticks ("
+              << log.bytes / static_cast<double>(totalScans) << " octets/tick, image dense : "
+              << static_cast<size_t>(map.getWidth()) * map.getHeight()
+              << " octets), relecture d'un tick au hasard : " << log.seekUs << " us" << std::endl;
+    std::cout << "Ecritures economisees par le pochoir : " << std::setprecision(1) << saved << " %" << std::endl;
+    std::cout << "Memoire des cases : " << grid.getAllocatedTileCount() << " tuiles allouees, " << grid.getCellMemoryBytes() / 1024
+              << " Ko (grille dense : " << static_cast<size_t>(map.getWidth()) * map.getHeight() / 1024 << " Ko)" << std::endl;
+    std::cout << "Grille compacte (2 bits/case) : " << packedBytes / 1024 << " Ko ; comptage des inconnues : "
+              << countBytesUs << " us (8 bits) / " << countPackedUs << " us (popcount)" << std::endl;
+    std::cout << "Requetes de zone (inconnu ? tout libre ?) : " << regionScanUs
+              << " us (parcours des cases) / " << regionPyramidUs << " us (pyramide)" << std::endl;
+}
+
+// =========================================================
+// POINT D'ENTRÉE
+// =========================================================
+int main(int argc, char** argv) {
+    std::string path = (argc > 1) ? argv[1] : "map.png";
+
+    cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+    if (image.empty()) {
+        std::cerr << "ERREUR : Impossible de charger la carte '" << path << "'" << std::endl;
+        return 1;
+    }
+
+    Map map(image);
+    std::vector<cv::Point> positions = samplePositions(map, NUM_POSITIONS);
+    if (positions.empty()) {
+        std::cerr << "Aucune position libre sur la carte " << path << std::endl;
+        return 1;
+    }
+    std::cout << "Carte " << path << " (" << map.getWidth() << "x" << map.getHeight()
+              << ", " << positions.size() << " positions, 4 orientations)" << std::endl;
+
+    // Capteur par défaut, puis un capteur plus dense et de plus longue portée
+    LidarConfig dense;
+    dense.numRays = 1440;
+    dense.maxRange = 200.0;
+    const LidarConfig configs[] = { LidarConfig(), dense };
+    for (const LidarConfig& config : configs) {
+        benchConfig(map, positions, config);
+    }
+
+    return 0;
+}
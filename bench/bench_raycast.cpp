@@ -0,0 +1,160 @@
+#include "../include/Map.hpp"
+#include "../include/Robot.hpp"
+#include "../include/Lidar.hpp"
+#include <opencv2/opencv.hpp>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <algorithm>
+
+// =========================================================
+// BENCHMARK : LANCER DE RAYONS DU LIDAR
+// =========================================================
+// Compare les algorithmes de lancer de rayons (DDA de référence, Sphere Tracing, DDA hiérarchique,
+// DDA par lots SIMD avec chaque jeu d'instructions, mode incrémental) sur la carte fournie et sur des versions agrandies de cette carte.
+//
+// Utilisation : ./bench_raycast [chemin/vers/map.png]
+
+// Nombre de positions de test par carte et nombre de répétitions de la mesure
+static const int NUM_POSITIONS = 200;
+static const int NUM_REPEATS = 5;
+
+// Résultat d'une mesure pour un algorithme donné
+struct ModeResult {
+    double nsPerRay;            // Temps moyen par rayon (nanosecondes)
+    double maxError;            // Écart maximal avec le DDA de référence (pixels)
+    std::vector<double> ranges; // Toutes les distances mesurées (pour la comparaison)
+};
+
+// Tire des positions libres au hasard (graine fixe pour des mesures reproductibles).
+// On garde une marge équivalente au rayon du robot, comme la simulation.
+static std::vector<cv::Point> samplePositions(const Map& map, int count) {
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<> distX(0, map.getWidth() - 1);
+    std::uniform_int_distribution<> distY(0, map.getHeight() - 1);
+
+    std::vector<cv::Point> positions;
+    int attempts = 0;
+    while (static_cast<int>(positions.size()) < count && attempts < 100000) {
+        attempts++;
+        cv::Point p(distX(gen), distY(gen));
+        if (map.getClearance(p.x, p.y) > 5.0f) {
+            positions.push_back(p);
+        }
+    }
+    return positions;
+}
+
+// Mesure un algorithme sur toutes les positions et les 4 orientations du robot
+static ModeResult runMode(Lidar& lidar, Robot& robot, const std::vector<cv::Point>& positions, RaycastMode mode) {
+    // Les 4 orientations possibles du robot (droite, bas, gauche, haut)
+    const int dirs[4][2] = { {1, 0}, {0, 1}, {-1, 0}, {0, -1} };
+
+    lidar.setRaycastMode(mode);
+
+    ModeResult result;
+    result.maxError = 0.0;
+    result.ranges.reserve(positions.size() * 4 * lidar.getRayCount());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < NUM_REPEATS; rep++) {
+        for (const cv::Point& p : positions) {
+            robot.setPosition(p);
+            for (const auto& d : dirs) {
+                robot.updateOrientation(d[0], d[1]);
+                std::vector<double> scan = lidar.readAll();
+                // On ne garde les distances qu'une fois (première répétition)
+                if (rep == 0) {
+                    result.ranges.insert(result.ranges.end(), scan.begin(), scan.end());
+                }
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double totalRays = static_cast<double>(NUM_REPEATS) * positions.size() * 4 * lidar.getRayCount();
+    double totalNs = std::chrono::duration<double, std::nano>(end - start).count();
+    result.nsPerRay = totalNs / totalRays;
+    return result;
+}
+
+// Lance tous les algorithmes sur une carte et affiche le tableau de résultats
+static void benchMap(const std::string& label, const cv::Mat& image) {
+    Map map(image);
+    Robot robot(cv::Point(0, 0), 11);
+    Lidar lidar(&map, &robot);
+
+    std::vector<cv::Point> positions = samplePositions(map, NUM_POSITIONS);
+    if (positions.empty()) {
+        std::cerr << "Aucune position libre sur la carte " << label << std::endl;
+        return;
+    }
+
+    // Le DDA sert de référence pour mesurer l'écart des autres algorithmes
+    ModeResult reference = runMode(lidar, robot, positions, RaycastMode::DDA);
+
+    struct NamedMode { const char* name; RaycastMode mode; SimdLevel level; };
+    const NamedMode modes[] = {
+        { "DDA", RaycastMode::DDA, SimdLevel::SCALAR },
+        { "SPHERE_TRACING", RaycastMode::SPHERE_TRACING, SimdLevel::SCALAR },
+        { "HIERARCHICAL", RaycastMode::HIERARCHICAL, SimdLevel::SCALAR },
+        { "SIMD (SCALAR)", RaycastMode::SIMD_BATCH, SimdLevel::SCALAR },
+        { "SIMD (SSE4)", RaycastMode::SIMD_BATCH, SimdLevel::SSE4 },
+        { "SIMD (AVX2)", RaycastMode::SIMD_BATCH, SimdLevel::AVX2 },
+        { "INCREMENTAL", RaycastMode::INCREMENTAL, SimdLevel::SCALAR },
+    };
+
+    std::cout << "\n--- Carte " << label << " (" << map.getWidth() << "x" << map.getHeight()
+              << ", " << positions.size() << " positions) ---" << std::endl;
+    std::cout << std::left << std::setw(18) << "Algorithme"
+              << std::right << std::setw(12) << "ns/rayon"
+              << std::setw(12) << "speedup"
+              << std::setw(16) << "ecart max (px)" << std::endl;
+
+    for (const NamedMode& m : modes) {
+        // Les niveaux SIMD non supportés par ce processeur ne sont pas mesurés
+        if (m.level > detectSimdLevel()) {
+            continue;
+        }
+        lidar.setSimdLevel(m.level);
+        ModeResult r = (m.mode == RaycastMode::DDA) ? reference : runMode(lidar, robot, positions, m.mode);
+
+        for (size_t i = 0; i < r.ranges.size(); i++) {
+            r.maxError = std::max(r.maxError, std::abs(r.ranges[i] - reference.ranges[i]));
+        }
+
+        std::cout << std::left << std::setw(18) << m.name
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(12) << r.nsPerRay
+                  << std::setprecision(2) << std::setw(12) << reference.nsPerRay / r.nsPerRay
+                  << std::setprecision(6) << std::setw(16) << r.maxError << std::endl;
+    }
+}
+
+// =========================================================
+// POINT D'ENTRÉE
+// =========================================================
+int main(int argc, char** argv) {
+    std::string path = (argc > 1) ? argv[1] : "map.png";
+
+    cv::Mat image = cv::imread(path, cv::IMREAD_COLOR);
+    if (image.empty()) {
+        std::cerr << "ERREUR : Impossible de charger la carte '" << path << "'" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Jeu d'instructions SIMD disponible : " << simdLevelName(detectSimdLevel()) << std::endl;
+
+    // Carte d'origine puis versions agrandies (plus de vide entre les murs)
+    const int scales[] = { 1, 2, 4 };
+    for (int scale : scales) {
+        cv::Mat scaled;
+        cv::resize(image, scaled, cv::Size(image.cols * scale, image.rows * scale), 0, 0, cv::INTER_NEAREST);
+        benchMap(path + " x" + std::to_string(scale), scaled);
+    }
+
+    return 0;
+}
@@ -6,6 +6,8 @@
 // Inclusion spécifique pour le module ArUco (Réalité Augmentée / Fiducial Markers)
 #include <opencv2/aruco.hpp>
 #include <vector>
+#include <string>
+#include <cstdint>
 
 // Déclaration anticipée de la classe BehaviorManager.
 // Cela permet de dire au compilateur que cette classe existe sans inclure tout son fichier .hpp ici,
@@ -20,15 +22,27 @@ public:
     
     // Constructeur : Initialise la caméra et les paramètres de détection ArUco
     // Prend en paramètre un pointeur vers le BehaviorManager pour pouvoir lui envoyer des commandes.
-    ArucoManager(BehaviorManager* behaviorMgr);
+    // useCamera = false : la caméra n'est pas ouverte (mode sans affichage), seuls les tags
+    // scriptés (injectMarker) pilotent le robot.
+    ArucoManager(BehaviorManager* behaviorMgr, bool useCamera = true);
     
     // Destructeur : Libère proprement les ressources (ferme la caméra)
     ~ArucoManager();
 
     // --- 2. MÉTHODES PRINCIPALES  ---
     
-    // Capture une image, détecte les tags, met à jour le comportement et dessine l'interface
-    void captureAndDetect();
+    // Capture une image, détecte les tags et dessine l'interface (modeName : mode affiché).
+    // Ne change pas le comportement : le tag détecté (getDetectedId()) est appliqué par la
+    // simulation, sur son thread, avec injectMarker().
+    void captureAndDetect(const std::string& modeName);
+
+    // Fait écrire les captures suivantes directement dans buffer (ex: zone caméra du tableau de
+    // bord, de la taille de la caméra) : ni copie ni allocation par image. Si la caméra change
+    // de taille, l'image est réallouée hors de buffer (getFrame() n'a plus la taille de buffer).
+    void setFrameBuffer(const cv::Mat& buffer);
+
+    // Applique un tag au BehaviorManager (tag détecté par la caméra, ou entrée scriptée)
+    void injectMarker(int id);
 
     // --- 3. GETTERS  ---
     
@@ -36,12 +50,28 @@ public:
     // Utile pour l'affichage dans la fenêtre principale
     cv::Mat getFrame() const;
 
+    // Retourne l'ID du tag détecté par le dernier captureAndDetect() (-1 : aucun)
+    // Utile pour enregistrer les entrées de la session (voir InputLog)
+    int getDetectedId() const;
+
+    // Retourne le nombre d'images allouées (capture, image de sortie) depuis la création :
+    // n'augmente plus une fois la taille de la caméra connue
+    uint64_t getAllocationCount() const;
+
 private:
     // --- MEMBRES ---
     
     BehaviorManager* behaviorManager; // Lien vers le cerveau du robot
     cv::VideoCapture cap;             // Objet OpenCV gérant le flux vidéo physique
+    cv::Mat rawFrame;                 // La dernière image brute (buffer réutilisé)
     cv::Mat currentFrame;             // La dernière image capturée et traitée
+    int detectedId;                   // Tag détecté à la dernière capture (-1 : aucun)
+    uint64_t allocationCount;         // Images allouées depuis la création
+
+    // Résultats de la détection, gardés d'une capture à l'autre (capacité réutilisée)
+    std::vector<int> ids;                            // Liste des IDs trouvés (ex: [0, 5])
+    std::vector<std::vector<cv::Point2f>> corners;   // Coordonnées des 4 coins pour chaque tag trouvé
+    std::vector<std::vector<cv::Point2f>> rejected;  // Candidats rejetés (bruit, formes carrées non valides)
     
     // Paramètres spécifiques à la librairie ArUco
     cv::Ptr<cv::aruco::Dictionary> dictionary;      // Le dictionnaire de tags autorisé 
@@ -49,8 +79,8 @@ private:
 
     // --- MÉTHODES PRIVÉES  ---
     
-    // Dessine l'interface utilisateur (HUD) sur l'image : texte, bandeau noir, ID détecté
-    void drawOverlay(cv::Mat& img, int detectedId);
+    // Dessine l'interface utilisateur (HUD) sur l'image : texte, bandeau noir, ID détecté, mode
+    void drawOverlay(cv::Mat& img, int detectedId, const std::string& modeName);
 };
 
 #endif // ARUCOMANAGER_HPP
\ No newline at end of file
@@ -7,6 +7,7 @@
 // Déclaration anticipée pour éviter les inclusions circulaires
 class Simulation; 
 class Robot;
+struct LidarScan;
 
 // Énumération fortement typée pour définir les états possibles du robot
 enum class Behavior {
@@ -33,12 +34,16 @@ public:
     
     // Calcule le déplacement (dx, dy) pour la frame actuelle.
     // Cette méthode est appelée à chaque tour de boucle par Simulation::run()
-    void execute(int& dx, int& dy, int key);
+    // scan : le scan Lidar du tick, partagé avec la grille et l'affichage
+    void execute(int& dx, int& dy, int key, const LidarScan& scan);
     
     // Réinitialise la mémoire interne de l'algorithme de navigation
     // (Utile quand on change de mode ou qu'on redémarre)
     void reset();
 
+    // Active / désactive les messages console (changement de mode, fin d'exploration)
+    void setVerbose(bool enabled);
+
     // --- 3. GETTERS (Accesseurs) ---
     
     // Retourne l'état actuel (enum)
@@ -58,18 +63,23 @@ private:
     int maneuverState;          // État de la manœuvre (0=Suivi, 1=Dégagement, 2=Virage, 3=Stabilisation)
     int stepCounter;            // Compteur pour temporiser les actions (avancer X frames)
     bool explorationCompleted;  // Est-ce que la carte est finie ?
+    bool verbose;               // Messages console (désactivés pour les lots d'épisodes)
 
     // Constantes de distances (en pixels)
     const double SIDE_WALL_DISTANCE;  // Distance idéale au mur latéral
     const double FRONT_WALL_DISTANCE; // Distance d'arrêt face à un mur
 
+    // Angles des rayons utilisés, relatifs à l'avant du robot (radians)
+    static constexpr double FRONT_ANGLE = 0.0;                      // Devant
+    static constexpr double RIGHT_ANGLE = 3.14159265358979323846 / 2.0; // À droite (+90 degrés, Y vers le bas)
+
     // --- MÉTHODES PRIVÉES (Implémentation des algos) ---
     
     // Gère le déplacement manuel via les touches ZQSD
     void executeManual(int& dx, int& dy, int key);
 
     // Gère l'algorithme autonome de suivi de mur (Main Droite / Main Gauche selon config)
-    void executeWallFollow(int& dx, int& dy);
+    void executeWallFollow(int& dx, int& dy, const LidarScan& scan);
 };
 
 #endif // BEHAVIORMANAGER_HPP
\ No newline at end of file
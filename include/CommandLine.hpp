@@ -0,0 +1,36 @@
+#ifndef COMMANDLINE_HPP
+#define COMMANDLINE_HPP
+
+#include <string>
+#include <cstdlib>
+#include <cstdint>
+
+// Outils de lecture de la ligne de commande, partagés par main et batch_explore
+
+// Lit un entier positif ou nul (tout le texte doit être un nombre)
+inline bool parseCount(const std::string& text, int& value) {
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || parsed < 0 || parsed > 1000000000L) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+// Lit une graine : entier de 1 à 2^32 - 1 (0 est réservé à la graine tirée au hasard)
+inline bool parseSeed(const std::string& text, unsigned& value) {
+    // strtoul accepte un signe moins (et le fait boucler) : seuls les chiffres sont admis
+    if (text.empty() || text[0] < '0' || text[0] > '9') {
+        return false;
+    }
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    if (*end != '\0' || parsed == 0 || parsed > UINT32_MAX) {
+        return false;
+    }
+    value = static_cast<unsigned>(parsed);
+    return true;
+}
+
+#endif // COMMANDLINE_HPP
@@ -0,0 +1,114 @@
+#ifndef INPUTLOG_HPP
+#define INPUTLOG_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "BehaviorManager.hpp"
+
+// Journal des entrées d'une session (fichier binaire compact), pour la rejouer à l'identique.
+// La simulation est déterministe : la graine de la position de départ et les entrées de chaque
+// tick (touche, tag ArUco) suffisent à reproduire exactement la trajectoire du robot et la grille.
+// Les changements de mode sont aussi notés : au rejeu, ils permettent de trouver le premier tick
+// où la session diverge. Le journal se termine par le nombre de ticks et les empreintes de la
+// trajectoire et de la grille finale, comparées à la fin du rejeu.
+//
+// Format (entiers en varint : 7 bits par octet, bit de poids fort = "octet suivant") :
+// - en-tête : "SIL1", graine, pas de temps (ms), longueur puis chemin de la carte ;
+// - enregistrement : écart de tick depuis l'enregistrement précédent, drapeaux, puis selon les
+//   drapeaux : touche (INPUT_KEY), ID du tag (INPUT_ARUCO), comportement + 1 (INPUT_MODE, un octet) ;
+// - fin (drapeau INPUT_END) : écart jusqu'au nombre de ticks, puis les deux empreintes
+//   (8 octets chacune, poids faible en premier).
+// Seuls les ticks avec une entrée ont un enregistrement : une session de suivi de mur lancée
+// par un tag tient en quelques dizaines d'octets.
+
+// Une entrée (plusieurs enregistrements peuvent avoir le même tick, dans l'ordre d'application)
+struct InputRecord {
+    int tick;          // Tick de l'entrée (0 = premier tick)
+    int key;           // Touche appuyée pendant ce tick (-1 : aucune)
+    int arucoId;       // Tag ArUco détecté (-1 : aucun)
+    bool modeChanged;  // Le comportement a changé pendant ce tick ...
+    Behavior behavior; // ... et voici le nouveau
+};
+
+// =========================================================
+// ÉCRITURE
+// =========================================================
+class InputLogWriter {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    InputLogWriter();
+    ~InputLogWriter();
+
+    // Crée le fichier (écrasé s'il existe) et écrit l'en-tête.
+    // Retourne false (avec un message d'erreur) si le fichier ne peut pas être créé.
+    bool open(const std::string& path, unsigned seed, const std::string& mapPath, int timestepMs);
+
+    // --- 2. ÉCRITURE ---
+
+    // Ajoute une entrée (ticks croissants)
+    void write(const InputRecord& record);
+
+    // Termine le journal : nombre de ticks et empreintes de la trajectoire et de la grille.
+    // Un journal fermé sans finish() (ex: arrêt brutal) reste rejouable, sans vérification finale.
+    void finish(int tickCount, uint64_t trajectoryHash, uint64_t gridHash);
+
+    // --- 3. GETTERS ---
+
+    bool isOpen() const;
+    size_t getBytesWritten() const;
+
+private:
+    std::ofstream out;
+    int lastTick;                 // Tick du dernier enregistrement
+    size_t bytesWritten;
+    std::vector<uint8_t> buffer;  // Octets de l'enregistrement en cours
+
+    // Écrit buffer dans le fichier
+    void flushBuffer();
+};
+
+// =========================================================
+// LECTURE
+// =========================================================
+class InputLogReader {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    InputLogReader();
+
+    // Lit tout le journal. Un journal tronqué garde ses enregistrements complets (isComplete()
+    // est alors faux). Retourne false (avec un message d'erreur) si le fichier n'est pas un
+    // journal d'entrées.
+    bool open(const std::string& path);
+
+    // --- 2. GETTERS ---
+
+    unsigned getSeed() const;
+    const std::string& getMapPath() const;
+    int getTimestepMs() const;
+
+    // Entrées, dans l'ordre d'enregistrement
+    const std::vector<InputRecord>& getRecords() const;
+
+    // Vrai si le journal a été terminé (finish()) : nombre de ticks et empreintes connus.
+    // Sinon, getTickCount() est le tick qui suit la dernière entrée.
+    bool isComplete() const;
+    int getTickCount() const;
+    uint64_t getTrajectoryHash() const;
+    uint64_t getGridHash() const;
+
+private:
+    unsigned seed;
+    std::string mapPath;
+    int timestepMs;
+    std::vector<InputRecord> records;
+    bool complete;
+    int tickCount;
+    uint64_t trajectoryHash;
+    uint64_t gridHash;
+};
+
+#endif // INPUTLOG_HPP
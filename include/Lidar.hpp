@@ -2,55 +2,309 @@
 #define LIDAR_HPP
 
 #include <vector>
+#include <functional>
 #include <opencv2/opencv.hpp>
+#include "LidarSimd.hpp"
+#include "ScanCache.hpp"
 
 // Déclarations anticipées pour éviter les inclusions circulaires
-class Simulation;
 class Robot;
 class Map;
+class ThreadPool;
+class OccupancyGrid;
+class RayStencil;
 
-// La classe Lidar simule un capteur de distance laser à 360 degrés.
+// Algorithme utilisé pour lancer les rayons
+enum class RaycastMode {
+    DDA = 0,           // Parcours case par case (Digital Differential Analyzer), référence
+    SPHERE_TRACING = 1, // Grands sauts dans l'espace libre grâce au champ de distance de la Map
+    HIERARCHICAL = 2,   // DDA qui traverse d'un coup les blocs vides de la pyramide de la Map
+    SIMD_BATCH = 3,     // DDA en float, 8 rayons à la fois (AVX2) ou 4 (SSE4) ; readAll() et scan() seulement
+    INCREMENTAL = 4     // Réutilise le scan précédent après un petit déplacement ; readAll() et scan() seulement
+};
+
+// Compteurs du mode incrémental (voir Lidar::getIncrementalStats())
+struct IncrementalStats {
+    long long incrementalScans = 0; // Scans servis par le chemin incrémental
+    long long fullScans = 0;        // Scans recalculés entièrement (vérifications échouées)
+    long long raysReused = 0;       // Rayons repris à partir de leur certificat
+    long long raysRecast = 0;       // Rayons lancés depuis le robot
+};
+
+// Modèle du capteur : nombre de rayons, champ de vision, orientation et portée.
+// Les angles sont relatifs à l'avant du robot (sens des Y croissants = vers la droite).
+// - Tour complet (fov = 2*PI) : rayon i à angleOffset - PI + i * 2*PI / numRays
+// - Secteur (fov < 2*PI) : numRays rayons répartis de -fov/2 à +fov/2 (bornes comprises)
+struct LidarConfig {
+    int numRays;        // Nombre de rayons du balayage
+    double fov;         // Champ de vision total (radians, 2*PI = tour complet)
+    double angleOffset; // Décalage du centre du balayage par rapport à l'avant du robot (radians)
+    double maxRange;    // Portée maximale (pixels)
+
+    // Configuration d'origine : 360 rayons (1 par degré), tour complet, portée 100 px
+    LidarConfig()
+        : numRays(360), fov(2.0 * 3.14159265358979323846), angleOffset(0.0), maxRange(100.0) {}
+
+    LidarConfig(int numRays_, double fov_, double angleOffset_, double maxRange_)
+        : numRays(numRays_), fov(fov_), angleOffset(angleOffset_), maxRange(maxRange_) {}
+
+    // Vrai si le balayage couvre un tour complet (le dernier rayon est voisin du premier)
+    bool isFullCircle() const { return fov >= 2.0 * 3.14159265358979323846 - 1e-9; }
+};
+
+// Résultat complet d'un balayage du Lidar (tous les rayons, une seule fois par tick).
+// Produit par Lidar::scan() et partagé par tous les consommateurs (comportement,
+// grille d'occupation, affichage) : tout le monde voit exactement le même scan.
+struct LidarScan {
+    cv::Point origin;                // Position du robot au moment du scan
+    std::vector<double> ranges;      // Distance mesurée par chaque rayon (pixels)
+    std::vector<double> angles;      // Angle absolu de chaque rayon (radians)
+    std::vector<cv::Point> hitPoints;// Point d'arrivée de chaque rayon dans le monde
+    std::vector<uchar> hits;         // 1 si le rayon a touché un mur avant la portée max
+
+    // Géométrie du balayage (angles relatifs à l'avant du robot), pour adresser les rayons par angle
+    double orientation = 0.0;        // Orientation du robot au moment du scan (radians)
+    double angleMin = 0.0;           // Angle relatif du rayon 0 (radians)
+    double angleStep = 0.0;          // Écart angulaire entre deux rayons voisins (radians)
+    bool fullCircle = true;          // Le balayage fait le tour complet
+
+    // Retourne l'indice du rayon le plus proche d'un angle relatif à l'avant du robot
+    // (0 = devant, PI/2 = à droite, PI = derrière, -PI/2 = à gauche).
+    // Hors du champ de vision d'un secteur, retourne le rayon du bord le plus proche.
+    int rayIndexAt(double relativeAngle) const;
+
+    // Retourne la distance mesurée par le rayon le plus proche de cet angle relatif
+    double rangeAt(double relativeAngle) const;
+};
+
+// La classe Lidar simule un capteur de distance laser (360 degrés par défaut).
 // Elle utilise un algorithme de lancer de rayons (Raycasting) pour détecter les murs.
 class Lidar {
 public:
     // --- 1. CONSTRUCTEUR ---
     
-    // Initialise le Lidar avec un lien vers la simulation (pour lire la carte)
-    Lidar(Simulation* simulation_);
+    // Initialise le Lidar avec la carte à scanner, le robot qui le porte et son modèle
+    Lidar(const Map* map_, const Robot* robot_, const LidarConfig& config_ = LidarConfig());
 
     // --- 2. MÉTHODES PRINCIPALES  ---
 
-    // Lance un seul rayon (identifié par son ID de 0 à 359) et retourne la distance
-    // Utilise l'algorithme DDA (Digital Differential Analyzer) pour la rapidité
+    // Lance un seul rayon (identifié par son ID de 0 à getRayCount() - 1) et retourne la distance
+    // Utilise l'algorithme choisi par setRaycastMode() (DDA par défaut).
+    // En mode SIMD_BATCH, c'est le DDA scalaire de référence qui est utilisé.
     double read(int rayID) const;
 
-    // Lance tous les rayons (0 à 359) et retourne un vecteur contenant toutes les distances
+    // Lance tous les rayons et retourne un vecteur contenant toutes les distances
     std::vector<double> readAll() const;
 
     // Convertit les distances mesurées en points (X, Y) réels dans le monde
     // C'est ce qui permet de construire la "Carte Mémoire" (OccupancyGrid)
     std::vector<cv::Point> getHitPoints(const Robot& robot) const;
 
+    // Lance tous les rayons une seule fois et remplit le scan complet
+    // (distances, angles, points d'impact, drapeaux de contact).
+    // Les vecteurs du scan sont réutilisés d'un appel à l'autre (pas de réallocation).
+    void scan(LidarScan& result) const;
+
+    // Même scan que scan(), en mettant à jour la grille d'occupation pendant le lancer de rayons :
+    // chaque case traversée par le DDA est marquée libre, la case du mur touché est marquée
+    // obstacle (un seul parcours par rayon, pas de second tracé de ligne dans la grille).
+    // Les distances sont celles du DDA de référence, quel que soit l'algorithme actif ;
+    // les rayons sont lancés en série (tous écrivent dans la même grille).
+    // Cache des scans actif : une pose déjà appliquée à la grille est servie par le cache sans
+    // toucher la grille (les mêmes rayons marqueraient les mêmes cases). Le Lidar suppose donc
+    // qu'il alimente toujours la même grille (appeler clearScanCache() si elle est remplacée).
+    void scanAndMap(LidarScan& result, OccupancyGrid& grid) const;
+
+    // Construit le pochoir des rayons (cases traversées par le DDA de chaque rayon, sans obstacle,
+    // pour l'orientation 0), utilisé par OccupancyGrid::update() pour ne pas retracer les rayons
+    void buildRayStencil(RayStencil& stencil) const;
+
     // --- 3. AFFICHAGE ---
 
-    // Dessine les rayons laser sur l'image de simulation (lignes rouges)
-    void draw(cv::Mat& image, const Robot& robot) const;
+    // Dessine les rayons laser d'un scan sur l'image de simulation (lignes rouges)
+    void draw(cv::Mat& image, const LidarScan& scan) const;
+
+    // --- 4. CONFIGURATION ---
+
+    // Change le modèle du capteur et reconstruit les tables d'angles.
+    // Retourne false (et garde l'ancien modèle) si la configuration est invalide.
+    bool setConfig(const LidarConfig& config);
+
+    // Choisit l'algorithme de lancer de rayons (DDA, Sphere Tracing, hiérarchique ou SIMD)
+    void setRaycastMode(RaycastMode mode);
+
+    // Force le jeu d'instructions du mode SIMD_BATCH (par défaut : le meilleur disponible).
+    // Un niveau non supporté par le processeur retombe sur la version scalaire.
+    void setSimdLevel(SimdLevel level);
 
-    // --- 4. GETTERS  ---
+    // Remet à zéro les compteurs du mode incrémental
+    void resetIncrementalStats();
+
+    // Active le cache des scans par pose (x, y, orientation) avec une limite mémoire en octets
+    // (0 = désactivé, valeur par défaut). Cache actif : les distances de readAll(), getHitPoints()
+    // et scan() sont quantifiées au pas de getMaxRange() / 65535 (et limitées à la portée maximale),
+    // qu'elles viennent du cache ou non.
+    void setScanCacheLimit(size_t maxBytes);
+
+    // Vide le cache des scans et remet ses compteurs à zéro
+    void clearScanCache();
+
+    // Partage un groupe de threads persistant pour lancer les rayons en parallèle
+    // (nullptr = tout en série). Le groupe n'est pas possédé par le Lidar.
+    // En dessous de PARALLEL_MIN_RAYS rayons, le balayage reste en série.
+    void setThreadPool(ThreadPool* pool);
+
+    // --- 5. GETTERS  ---
+
+    // Retourne le modèle du capteur
+    const LidarConfig& getConfig() const;
 
     // Retourne le nombre total de rayons (ex: 360)
     int getRayCount() const;
 
-    // Retourne la portée maximale du capteur (ex: 250.0 pixels)
+    // Retourne la portée maximale du capteur (ex: 100.0 pixels)
     double getMaxRange() const;
 
+    // Retourne l'algorithme de lancer de rayons actif
+    RaycastMode getRaycastMode() const;
+
+    // Retourne le jeu d'instructions utilisé par le mode SIMD_BATCH
+    SimdLevel getSimdLevel() const;
+
+    // Retourne les compteurs du mode incrémental (taux de réussite du chemin incrémental)
+    IncrementalStats getIncrementalStats() const;
+
+    // Retourne les compteurs du cache des scans (succès, échecs, mémoire occupée)
+    ScanCacheStats getScanCacheStats() const;
+
 private:
     // --- CONSTANTES ---
-    const int num_rays = 360;       // Résolution angulaire (1 rayon par degré)
-    const double max_range = 100.0; // Portée max en pixels (Augmentée pour voir les coins)
+
+    // Marge de sécurité du Sphere Tracing (en pixels) : sqrt(2) arrondi au-dessus.
+    // Le champ de distance est mesuré entre centres de cases, alors que le rayon peut
+    // passer n'importe où dans sa case et toucher n'importe quel coin du mur.
+    static constexpr double SPHERE_MARGIN = 1.5;
+
+    // Largeur (en pixels, de chaque côté du rayon) du tube garanti sans mur lors d'un lancer
+    // complet du mode INCREMENTAL. Tant que le robot reste à moins de cette distance de la
+    // position du lancer complet, chaque rayon est repris près de son impact.
+    // Plus large : moins de lancers complets, mais des reprises qui partent de plus loin.
+    static constexpr double INCREMENTAL_TUBE = 3.0;
+
+    // Nombre minimal de rayons pour répartir le balayage sur plusieurs threads
+    // (en dessous, réveiller les threads coûte plus que le calcul lui-même)
+    static const int PARALLEL_MIN_RAYS = 512;
+
+    // Nombre de rayons par bloc de travail : des rayons voisins lisent les mêmes lignes
+    // du bitmap (meilleur usage du cache), et 64 est un multiple des lots SIMD (4 ou 8)
+    static const int RAY_CHUNK = 64;
 
     // --- MEMBRES ---
-    Simulation* simulation; // Pointeur vers la simulation pour accéder à la Map et au Robot
+    const Map* map;     // Carte scannée (murs + champ de distance)
+    const Robot* robot; // Robot portant le capteur (position + orientation)
+    RaycastMode mode;   // Algorithme de lancer de rayons actif
+    SimdLevel simdLevel;// Jeu d'instructions du mode SIMD_BATCH (détecté au démarrage)
+    ThreadPool* pool;   // Groupe de threads partagé (nullptr = en série)
+
+    LidarConfig config;  // Modèle du capteur
+
+    // Tables des rayons, construites une fois par configuration (setConfig()) :
+    // angle, cosinus et sinus de chaque rayon par rapport à l'avant du robot.
+    // Aucun cos/sin n'est calculé par rayon : les directions absolues sont obtenues
+    // en tournant ces vecteurs de l'orientation du robot.
+    // Pour un tour complet dont le nombre de rayons est multiple de 4, le rayon
+    // i + numRays/4 est exactement le rayon i tourné d'un quart de tour.
+    std::vector<double> rayAngle;
+    std::vector<double> rayCos;
+    std::vector<double> raySin;
+    double rayStep;     // Écart angulaire entre deux rayons voisins (radians)
+
+    // État du mode incrémental : certificats du dernier scan.
+    // "mutable" car mis à jour par scan() / readAll(), qui restent const pour les appelants.
+    struct IncrementalState {
+        bool valid = false;            // Un scan précédent est disponible
+        cv::Point origin;              // Position du robot lors du dernier scan
+        double orientation = 0.0;      // Orientation du robot lors du dernier scan
+        double radius = 0.0;           // Largeur du tube encore garantie autour des rayons
+        std::vector<double> freeDist;  // Pour chaque rayon : distance jusqu'où le tube est sans mur
+    };
+    mutable IncrementalState incremental;
+    mutable IncrementalStats incrementalStats;
+
+    // Scans déjà calculés, par pose du robot ("mutable" pour la même raison)
+    mutable ScanCache scanCache;
+
+    // --- MÉTHODES PRIVÉES ---
+
+    // Construit les tables des rayons pour la configuration courante
+    void buildTables();
+
+    // Calcule la direction absolue (unitaire) de tous les rayons pour une orientation du robot
+    void computeDirections(double orientation, std::vector<double>& dirX, std::vector<double>& dirY) const;
+
+    // Lance un rayon de direction (dirX, dirY) avec l'algorithme actif
+    // (DDA de référence pour le mode SIMD_BATCH)
+    double castRay(double startX, double startY, double dirX, double dirY) const;
+
+    // Distances de tous les rayons (directions absolues dirX / dirY) pour la pose courante du robot
+    // (utilisé par readAll(), getHitPoints() et scan()) : servies par le cache des scans si la
+    // pose y est, sinon lancées par castAllRays() puis mises en cache.
+    void castAll(const std::vector<double>& dirX, const std::vector<double>& dirY,
+                 std::vector<double>& ranges) const;
+
+    // Lance tous les rayons avec l'algorithme actif et range les distances dans 'ranges'.
+    // En mode SIMD_BATCH, passe par castRayBatch().
+    void castAllRays(const std::vector<double>& dirX, const std::vector<double>& dirY,
+                     std::vector<double>& ranges) const;
+
+    // Exécute body(begin, end) sur tous les rayons, découpés en blocs de RAY_CHUNK rayons
+    // répartis sur le groupe de threads (ou en un seul appel si le balayage reste en série)
+    void forEachRayChunk(const std::function<void(int, int)>& body) const;
+
+    // Parcours DDA case par case depuis (startX, startY) dans la direction (dirX, dirY).
+    // Retourne la distance du premier mur touché, ou maxDist si rien n'est touché
+    // (une sortie de carte compte comme "rien touché").
+    // skipDist : reprend le parcours à cette distance, les cases avant sont supposées libres.
+    double castDDA(double startX, double startY, double dirX, double dirY,
+                   double maxDist, double skipDist = 0.0) const;
+
+    // Parcours DDA commun à castDDA() et scanAndMap() (défini dans Lidar.cpp).
+    // visitor.freeCell(x, y) est appelé pour chaque case libre traversée avant maxDist
+    // (case de départ comprise), visitor.hitCell(x, y) pour le mur touché dans la carte avant maxDist.
+    template <class Visitor>
+    double traverseDDA(double startX, double startY, double dirX, double dirY,
+                       double maxDist, double skipDist, Visitor& visitor) const;
+
+    // Remplit la taille et la géométrie du scan, et calcule la direction de chaque rayon
+    void beginScan(LidarScan& result, std::vector<double>& dirX, std::vector<double>& dirY) const;
+
+    // Complète le scan à partir des distances : angles, drapeaux de contact, points d'impact
+    void finishScan(LidarScan& result, const std::vector<double>& dirX, const std::vector<double>& dirY) const;
+
+    // Mode incrémental : si le robot est resté dans le tube garanti du scan précédent (et a gardé
+    // la même orientation à un quart de tour près), chaque rayon reprend le DDA à la distance
+    // garantie libre ; sinon lancer complet et nouveaux certificats.
+    // Les distances sont identiques à celles du DDA de référence.
+    void castIncremental(const std::vector<double>& dirX, const std::vector<double>& dirY,
+                         std::vector<double>& ranges) const;
+
+    // Avance par grands pas (champ de distance) tant qu'aucun mur n'est à moins de
+    // tubeRadius de part et d'autre du rayon. Retourne la distance atteinte :
+    // toutes les cases du tube avant cette distance sont libres.
+    double certifyFreeDistance(double startX, double startY, double dirX, double dirY,
+                               double tubeRadius, double fromDist = 0.0) const;
+
+    // Sphere Tracing : avance par grands pas tant que le champ de distance garantit
+    // qu'aucun mur n'est proche, puis reprend le DDA près de l'obstacle.
+    // Le résultat est identique à celui du DDA complet.
+    double castSphereTraced(double startX, double startY, double dirX, double dirY) const;
+
+    // DDA hiérarchique : tant que la case courante est dans un bloc sans mur de la pyramide
+    // de la Map, saute directement au pas exact qui fait sortir de ce bloc.
+    // Le résultat est identique bit à bit à celui de castDDA().
+    // skipDist : reprend le parcours à cette distance, comme pour castDDA().
+    double castHierarchical(double startX, double startY, double dirX, double dirY,
+                            double maxDist, double skipDist = 0.0) const;
 };
 
 #endif // LIDAR_HPP
\ No newline at end of file
@@ -0,0 +1,56 @@
+#ifndef LIDARSIMD_HPP
+#define LIDARSIMD_HPP
+
+#include <cstdint>
+
+// Noyaux SIMD du Lidar : lancer de rayons DDA par lots (4 ou 8 rayons à la fois).
+// Les calculs se font en float (une voie SIMD par rayon) : chaque voie avance en X ou en Y
+// selon sa propre direction, et son résultat est figé (masque des voies actives) dès qu'elle
+// a touché un mur ou atteint la portée maximale. Le lot s'arrête quand toutes les voies ont fini.
+// Les distances des côtés sont calculées directement (sideDist0 + n * deltaDist), comme dans
+// le DDA de référence, pour que l'erreur d'arrondi reste bornée.
+//
+// Seul cas où le float pourrait s'écarter du DDA en double : un rayon qui passe (presque)
+// exactement par un coin de case, où l'ordre des pas X / Y dépend de l'arrondi. Ces rayons
+// sont marqués AMBIGUOUS_RANGE et doivent être relancés avec le DDA scalaire de référence ;
+// tous les autres ont la même suite de cases que le DDA en double.
+
+// Valeur renvoyée pour un rayon ambigu (à relancer avec le DDA de référence)
+const float AMBIGUOUS_RANGE = -1.0f;
+
+// Jeu d'instructions utilisé par les noyaux (choisi à l'exécution)
+enum class SimdLevel {
+    SCALAR = 0, // Version portable (un rayon à la fois, même algorithme en float)
+    SSE4 = 1,   // 4 rayons à la fois (SSE4.1)
+    AVX2 = 2    // 8 rayons à la fois (AVX2, avec "gather" des bits d'obstacle)
+};
+
+// Paramètres d'un lot de rayons partant tous du même point
+struct RayBatch {
+    float originX, originY; // Point de départ commun (centre du robot)
+    const float* dirX;      // Direction de chaque rayon (vecteurs unitaires)
+    const float* dirY;
+    int count;              // Nombre de rayons
+    float maxDist;          // Portée maximale du capteur
+};
+
+// Vue brute sur le bitmap des obstacles de la Map (voir Map::getObstacleBits)
+struct ObstacleBitmap {
+    const uint64_t* bits; // Bitmap, bordure de garde comprise
+    int stride;           // Mots de 64 bits par ligne
+    int guard;            // Largeur de la bordure de garde (Map::GUARD)
+    int width, height;    // Dimensions de la carte (hors bordure)
+};
+
+// Retourne le meilleur jeu d'instructions supporté par le processeur courant
+SimdLevel detectSimdLevel();
+
+// Retourne le nom lisible d'un jeu d'instructions (pour l'affichage)
+const char* simdLevelName(SimdLevel level);
+
+// Lance tous les rayons du lot avec le jeu d'instructions demandé.
+// outRanges doit pouvoir contenir batch.count valeurs (AMBIGUOUS_RANGE pour les rayons ambigus).
+// Si le processeur ne supporte pas 'level', la version SCALAR est utilisée.
+void castRayBatch(SimdLevel level, const ObstacleBitmap& map, const RayBatch& batch, float* outRanges);
+
+#endif // LIDARSIMD_HPP
@@ -3,25 +3,64 @@
 
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <vector>
+#include <cstdint>
 
 // La classe Map gère l'environnement statique de la simulation ("Vérité Terrain").
 // Elle charge une image depuis le disque où :
 // - Les pixels NOIRS (0,0,0) sont considérés comme des murs.
 // - Les autres pixels (blancs/gris) sont des zones libres.
+//
+// Au chargement, l'image est convertie en un bitmap compact (1 bit par case) entouré
+// d'une bordure de garde remplie de murs. Toutes les requêtes d'obstacle sont servies
+// par ce bitmap : l'image BGR ne sert plus qu'à l'affichage.
+// Un champ de distance (distance de chaque case au mur le plus proche) est aussi
+// calculé une fois pour toutes : il sert au test de collision et au "sphere tracing".
+// Enfin, une pyramide de bitmaps (mip-maps "max") indique pour des blocs de 2x2, 4x4...
+// jusqu'à 64x64 cases s'ils contiennent au moins un mur : le Lidar s'en sert pour
+// traverser les grandes zones vides d'un seul coup.
 class Map {
 public:
+    // --- CONSTANTES ---
+
+    // Largeur de la bordure de garde (en cases) ajoutée autour de la carte dans le bitmap.
+    // Les cases de la bordure sont des murs : un rayon ou un test de collision qui sort
+    // de la carte s'arrête dessus sans qu'aucun test de limites ne soit nécessaire.
+    static const int GUARD = 64;
+
+    // Nombre de niveaux de la pyramide d'obstacles (niveau L = blocs de 2^L x 2^L cases).
+    // Le dernier niveau (blocs de 64 cases) est aligné sur la bordure de garde.
+    static const int PYRAMID_LEVELS = 6;
+
     // --- 1. CONSTRUCTEUR ---
-    
+
     // Charge l'image spécifiée par 'filename' (ex: "map.png") en mémoire.
     // Arrête le programme si l'image est introuvable.
     Map(const std::string& filename);
 
+    // Construit la carte à partir d'une image BGR déjà en mémoire
+    // (utile pour les benchmarks ou pour générer des cartes agrandies).
+    Map(const cv::Mat& bgrImage);
+
     // --- 2. MÉTHODES PRINCIPALES (Logique) ---
 
     // Vérifie si une coordonnée (x, y) donnée est un obstacle.
     // Retourne true si c'est un mur (pixel noir) ou si on est hors de la carte.
+    // Précondition : x dans [-GUARD, largeur + GUARD[ et y dans [-GUARD, hauteur + GUARD[
+    // (aucun test de limites n'est fait, c'est la bordure de garde qui protège l'accès).
     bool isObstacle(int x, int y) const;
 
+    // Retourne la distance euclidienne (en pixels) entre le centre de la case (x, y)
+    // et le centre de l'obstacle le plus proche (les cases hors carte sont des murs).
+    // Retourne 0 sur un mur ou hors de la carte.
+    float getClearance(int x, int y) const;
+
+    // Vérifie si le bloc de niveau 'level' (2^level x 2^level cases, 1 <= level <= PYRAMID_LEVELS)
+    // contenant la case (x, y) contient au moins un obstacle.
+    // Les blocs sont alignés sur le bitmap (bordure de garde comprise), même précondition
+    // que isObstacle() sur (x, y).
+    bool blockHasObstacle(int level, int x, int y) const;
+
     // --- 3. GETTERS (Accesseurs) ---
 
     // Retourne l'image brute de la carte (utile pour l'affichage)
@@ -33,12 +72,74 @@ public:
     // Retourne la hauteur de la carte en pixels
     int getHeight() const;
 
+    // Retourne le fichier d'où la carte a été chargée (vide : carte construite depuis une image)
+    const std::string& getPath() const;
+
+    // Accès brut au bitmap des obstacles (pour les noyaux SIMD du Lidar).
+    // La case (x, y) est le bit (x + GUARD) de la ligne (y + GUARD), chaque ligne
+    // faisant getBitsStride() mots de 64 bits.
+    const uint64_t* getObstacleBits() const;
+
+    // Retourne le nombre de mots de 64 bits par ligne du bitmap des obstacles
+    int getBitsStride() const;
+
 private:
     // --- MEMBRES ---
-    
-    cv::Mat image; // Matrice OpenCV contenant les données de l'image (pixels BGR)
+
+    cv::Mat image; // Matrice OpenCV contenant les données de l'image (pixels BGR), pour l'affichage
+    std::string path; // Fichier de l'image (vide si construite depuis une image en mémoire)
     int height;    // Hauteur de l'image (lignes / rows)
     int width;     // Largeur de l'image (colonnes / cols)
+
+    // Bitmap des obstacles : 1 bit par case, bordure de garde comprise.
+    // La case (x, y) correspond au bit (x + GUARD) de la ligne (y + GUARD).
+    std::vector<uint64_t> obstacleBits;
+    int bitsStride; // Nombre de mots de 64 bits par ligne du bitmap
+
+    cv::Mat distanceField; // Distance au mur le plus proche pour chaque case (CV_32F)
+
+    // Pyramide d'obstacles : pyramidBits[L - 1] contient 1 bit par bloc de niveau L
+    // (1 si le bloc contient au moins un mur), même organisation que obstacleBits.
+    std::vector<std::vector<uint64_t>> pyramidBits;
+    std::vector<int> pyramidStride; // Nombre de mots de 64 bits par ligne, pour chaque niveau
+
+    // --- MÉTHODES PRIVÉES ---
+
+    // Initialise les dimensions et les structures dérivées de l'image (bitmap, distances)
+    void initialize();
+
+    // Construit le bitmap des obstacles à partir de l'image BGR
+    void buildObstacleBits();
+
+    // Calcule le champ de distance (transformée de distance euclidienne exacte)
+    void buildDistanceField();
+
+    // Construit la pyramide d'obstacles niveau par niveau à partir du bitmap
+    void buildPyramid();
 };
 
-#endif // MAP_HPP
\ No newline at end of file
+// Définie dans l'en-tête pour être "inlinée" : cette fonction est appelée dans les
+// boucles les plus internes (raycasting du Lidar, test de collision).
+inline bool Map::isObstacle(int x, int y) const {
+    const unsigned col = static_cast<unsigned>(x + GUARD);
+    const size_t row = static_cast<size_t>(y + GUARD);
+    return (obstacleBits[row * bitsStride + (col >> 6)] >> (col & 63)) & 1u;
+}
+
+inline bool Map::blockHasObstacle(int level, int x, int y) const {
+    const unsigned col = static_cast<unsigned>(x + GUARD) >> level;
+    const size_t row = static_cast<size_t>(y + GUARD) >> level;
+    const std::vector<uint64_t>& bits = pyramidBits[level - 1];
+    return (bits[row * pyramidStride[level - 1] + (col >> 6)] >> (col & 63)) & 1u;
+}
+
+inline float Map::getClearance(int x, int y) const {
+    // Un seul test non signé par axe couvre à la fois les valeurs négatives et trop grandes
+    if (static_cast<unsigned>(x) >= static_cast<unsigned>(width) ||
+        static_cast<unsigned>(y) >= static_cast<unsigned>(height)) {
+        return 0.0f;
+    }
+    return distanceField.ptr<float>(y)[x];
+}
+
+#endif // MAP_HPP
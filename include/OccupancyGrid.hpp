@@ -2,13 +2,60 @@
 #define OCCUPANCYGRID_HPP
 
 #include <opencv2/opencv.hpp>
+#include <memory>
+#include <mutex>
 #include <vector>
+#include <cstdint>
+#include "RayStencil.hpp"
+#include "OccupancySimd.hpp"
+#include "OccupancyPyramid.hpp"
+
+struct LidarScan; // Déclaration anticipée (définie dans Lidar.hpp)
+class Lidar;
+class PackedTriStateGrid;
+class OccupancySnapshot;
+
+// Représentation des cases de la grille
+enum class OccupancyMode {
+    BINARY = 0,  // États durs 0 / 127 / 255 : un impact fait un obstacle définitif
+    LOG_ODDS = 1 // Probabilité d'occupation en log-odds (virgule fixe 16 bits), état affiché par seuils
+};
+
+// Modèle probabiliste du mode LOG_ODDS, en centièmes de log-odds (100 = log(p / (1 - p)) de 1).
+// Les valeurs par défaut gardent le comportement du mode BINARY sur une case inconnue
+// (un passage la rend libre, un impact en fait un obstacle), mais une case vue libre plusieurs
+// fois résiste à un impact isolé, et un obstacle vu libre plusieurs fois disparaît.
+struct LogOddsConfig {
+    int hit = 85;               // Impact : p(occupé | impact) = 0.7
+    int miss = -40;             // Traversée : p(occupé | traversée) = 0.4
+    int minValue = -400;        // Bornes : aucune case n'est jamais certaine (p entre 0.018 et 0.982),
+    int maxValue = 400;         // pour qu'elle puisse encore changer d'état
+    int occupiedThreshold = 85; // Obstacle affiché (0) à partir de p = 0.7
+    int freeThreshold = -40;    // Libre affiché (255) jusqu'à p = 0.4 ; entre les deux : inconnu (127)
+};
 
 // La classe OccupancyGrid gère la "mémoire" spatiale du robot.
 // Elle divise le monde en une grille de cellules. Chaque cellule contient une probabilité d'occupation :
 // - 127 : Zone Inconnue (Gris) - État initial
 // - 255 : Zone Libre (Blanc) - Le laser a traversé cette zone
 // - 0   : Obstacle (Noir) - Le laser a tapé quelque chose ici
+// En mode LOG_ODDS, chaque case garde en plus un log-odds, et ces trois états deviennent une vue
+// seuillée de la probabilité (tenue à jour à chaque scan) : draw, isFullyExplored et smoothGrid
+// fonctionnent sans changement.
+// Le nombre de cases de chaque état est tenu à jour à chaque changement (update, smoothGrid) :
+// le ratio d'exploration ne demande jamais de parcourir la grille.
+// La grille est découpée en tuiles de TILE_SIZE x TILE_SIZE cases, allouées à la première
+// écriture : une tuile jamais touchée n'occupe aucune mémoire (toutes ses cases sont inconnues),
+// la mémoire suit donc la zone explorée et non la taille de la carte. Les tuiles sont rangées
+// dans une table indexée par leur position (accès direct, sans recherche) ; une tuile absente
+// y pointe vers une tuile inconnue partagée, en lecture seule : la lecture d'une case ne teste
+// jamais l'absence, seule l'écriture d'une case qui change d'état peut allouer. Les tuiles
+// redevenues entièrement inconnues (recount()) retournent dans une réserve réutilisée avant
+// toute nouvelle allocation.
+// Chaque changement marque aussi sa tuile : le lissage comme l'affichage ne retraitent que
+// les tuiles modifiées (un scan ne touche que le disque de portée du Lidar autour du robot).
+// La grille elle-même n'est utilisée que par un thread ; les autres threads lisent des
+// instantanés publiés par celui-ci (voir publishSnapshot() et OccupancySnapshot).
 class OccupancyGrid {
 public:
     // --- 1. CONSTRUCTEUR ---
@@ -18,32 +65,177 @@ public:
     // cellSize : Taille d'une case en pixels (ex: 10px = 1 case)
     OccupancyGrid(int width, int height, int cellSize = 1);
 
+    // Non copiable : la table des tuiles pointe vers la tuile inconnue de l'objet lui-même
+    OccupancyGrid(const OccupancyGrid&) = delete;
+    OccupancyGrid& operator=(const OccupancyGrid&) = delete;
+
     // --- 2. MÉTHODES PRINCIPALES (Logique de Mapping) ---
 
     // Met à jour la grille en fonction des mesures du Lidar.
     // Utilise le "Raycasting" pour tracer des lignes de vide entre le robot et les obstacles.
     void update(const std::vector<cv::Point>& scanPoints, cv::Point robotPos);
 
+    // Même mise à jour à partir du scan partagé du tick.
+    // Si un pochoir de rayons a été construit (useRayStencil()) et que l'orientation du robot est
+    // un multiple d'un quart de tour, les rayons ne sont pas retracés : chaque case libre est
+    // écrite une seule fois par scan, et chaque rayon s'arrête à la case de son impact (voir
+    // RayStencil). Ce chemin n'est utilisé que par les benchmarks (la simulation passe par
+    // Lidar::scanAndMap()).
+    // Sinon, même tracé de lignes que update(scanPoints, robotPos).
+    void update(const LidarScan& scan);
+
+    // Construit le pochoir des rayons du Lidar (une fois, ou après un changement de modèle du capteur)
+    void useRayStencil(const Lidar& lidar);
+
+    // Encadrent les marquages d'un scan (appelées par update() et Lidar::scanAndMap()).
+    // En mode LOG_ODDS, les cases marquées entre les deux sont accumulées dans une fenêtre
+    // (une seule évidence par case et par scan, l'impact l'emporte), puis appliquées ligne par
+    // ligne en SIMD par endScanUpdate(). area : rectangle (pixels du monde) contenant les cases
+    // du scan ; une case marquée hors de ce rectangle est appliquée tout de suite.
+    // Sans effet en mode BINARY.
+    void beginScanUpdate(const cv::Rect& area);
+    void endScanUpdate();
+    // Mise à jour case par case, appelée par le Lidar pendant le lancer de rayons
+    // (voir Lidar::scanAndMap()). (x, y) est un pixel du monde ; hors grille : ignoré.
+
+    // Marque comme libre la case contenant le pixel (x, y) (un obstacle reste un obstacle).
+    // Retourne false si le pixel est hors de la grille.
+    bool markFree(int x, int y);
+
+    // Marque comme obstacle la case contenant le pixel (x, y) ; false si hors de la grille
+    bool markOccupied(int x, int y);
+
     // Nettoie la carte pour boucher les petits trous et supprimer le bruit.
     // Utilise des opérations morphologiques (Dilatation/Érosion).
+    // Seules les tuiles où un obstacle est apparu depuis le dernier lissage sont traitées
+    // (avec une marge de 2 * iterations cases : le résultat est le même que sur toute la grille).
     void smoothGrid(int iterations = 1);
 
-    // Vérifie le pourcentage de la carte qui a été découvert.
-    // Retourne true si le ratio de zones inconnues est faible.
+    // Vérifie le pourcentage de la carte qui a été découvert (en temps constant).
+    // Retourne true si le ratio de zones inconnues est sous le seuil (voir setExplorationThreshold()).
     bool isFullyExplored() const;
 
+    // Change le seuil de fin d'exploration : ratio de cases inconnues (0..1) sous lequel
+    // la carte est considérée comme complète (0.311 par défaut, pour tolérer les zones
+    // inaccessibles derrière les murs)
+    void setExplorationThreshold(double unknownRatio);
+
+    // Recompte les cases de chaque état et marque toute la grille comme modifiée.
+    // Les tuiles redevenues entièrement inconnues sont rendues à la réserve.
+    void recount();
+
+    // Remplace toutes les cases (CV_8UC1, gridH x gridW, valeurs 0 / 127 / 255), par exemple une
+    // copie de getGrid() modifiée. En mode LOG_ODDS, seule la vue seuillée change, pas les log-odds.
+    // Retourne false (avec un message d'erreur) si l'image n'a pas la taille ou le type de la grille.
+    bool setCells(const cv::Mat& cells);
+
+    // Change la représentation des cases. Passer en LOG_ODDS part de l'état courant
+    // (obstacle : seuil d'obstacle, libre : seuil de libre, inconnu : 0) ;
+    // revenir en BINARY garde la vue seuillée et oublie les log-odds.
+    void setMode(OccupancyMode mode);
+
+    // Change le modèle probabiliste (valeurs limitées aux int16, seuils dans [minValue, maxValue])
+    void setLogOddsConfig(const LogOddsConfig& config);
     // --- 3. AFFICHAGE ---
 
     // Dessine la grille sur une image affichable (conversion Grille -> Pixels).
     // Permet de visualiser ce que le robot a "compris" de son environnement.
+    // L'image de la grille est gardée d'un appel à l'autre : seules les tuiles modifiées
+    // depuis le dernier appel sont redessinées (table de couleurs, agrandissement au plus
+    // proche voisin si cellSize > 1), puis l'image est copiée dans displayImage
+    // (sans réallocation si displayImage a déjà la bonne taille).
     void draw(cv::Mat& displayImage);
 
-    // --- 4. GETTERS (Accesseurs) ---
+    // --- 4. REQUÊTES DE ZONE (Pyramide multi-résolution) ---
+    // Une pyramide de versions grossières de la grille (voir OccupancyPyramid) est mise à jour
+    // au-dessus des tuiles modifiées, au moment de la requête suivante. La recherche descend
+    // depuis le nœud qui couvre toute la grille, et ne descend pas sous un nœud uniforme (un seul
+    // état), entièrement dans la zone, ou qui n'apporte aucun état nouveau : une zone uniforme
+    // (toute libre, toute inconnue...) est réglée en O(log n) niveaux, sans parcourir ses cases.
+    // Les zones sont en cases de la grille (comme getCell()), limitées à la grille.
+
+    // États (REGION_*) présents dans la zone. La recherche s'arrête dès qu'un des états de
+    // stopStates est trouvé (0 : toute la zone est parcourue).
+    uchar getRegionStates(const cv::Rect& cells, uchar stopStates = 0) const;
+
+    // Au moins une case inconnue / un obstacle dans la zone
+    bool hasUnknown(const cv::Rect& cells) const;
+    bool hasObstacle(const cv::Rect& cells) const;
+
+    // Toutes les cases de la zone (non vide) sont libres
+    bool isRegionFree(const cv::Rect& cells) const;
+
+    // Vue grossière pour la planification : états (REGION_*) du nœud (nx, ny) du niveau 'level',
+    // qui couvre 2^level x 2^level cases (niveau 0 : une case ; 0 hors de la grille)
+    uchar getCoarseStates(int level, int nx, int ny) const;
+
+    // Niveau le plus grossier (un seul nœud pour toute la grille)
+    int getPyramidLevels() const;
+
+    // --- 5. INSTANTANÉS (Lecture depuis d'autres threads) ---
+
+    // Publie une vue figée de l'état courant de la grille et la retourne. À appeler par le
+    // thread qui met la grille à jour, entre deux scans (après endScanUpdate()). Les tuiles sont
+    // partagées : la grille copie une tuile seulement à sa première écriture qui suit.
+    std::shared_ptr<const OccupancySnapshot> publishSnapshot();
+
+    // Dernier instantané publié (nullptr si aucun) : appelable depuis n'importe quel thread.
+    // Le verrou ne protège que la copie du pointeur : la mise à jour ne l'attend jamais longtemps.
+    std::shared_ptr<const OccupancySnapshot> getSnapshot() const;
+
+    // --- 6. GETTERS (Accesseurs) ---
+
+    // Retourne une copie dense de la grille (0 / 127 / 255), reconstruite à chaque appel
+    // (la modifier ne change pas la grille, voir setCells()). Coûteux : toute la carte est allouée.
+    cv::Mat getGrid() const;
+
+    // État (0 / 127 / 255) de la case (gx, gy) de la grille (127 hors de la grille)
+    uchar getCell(int gx, int gy) const;
+
+    // Copie compacte de la grille (2 bits par case, voir PackedTriStateGrid) : seules les tuiles
+    // allouées sont converties. Pour les statistiques ou l'export de toute la carte.
+    void toPacked(PackedTriStateGrid& packed) const;
+
+    // Nombre de tuiles allouées (et octets de cases qu'elles occupent, log-odds compris)
+    int getAllocatedTileCount() const;
+    size_t getCellMemoryBytes() const;
+
+    // Retourne le nombre de cases écrites par le dernier update() (mesure de performance)
+    int getLastUpdateCellCount() const;
+
+    // Nombre de cases de chaque état (tenus à jour, sans parcourir la grille)
+    int getUnknownCount() const;
+    int getFreeCount() const;
+    int getOccupiedCount() const; // Toutes les cases ni inconnues ni libres
+
+    // Retourne le ratio de cases inconnues (0..1)
+    double getUnknownRatio() const;
+
+    // Retourne le seuil de fin d'exploration
+    double getExplorationThreshold() const;
+
+    // Nombre de tuiles modifiées en attente d'affichage / de lissage
+    int getRenderDirtyTileCount() const;
+    int getSmoothDirtyTileCount() const;
+
+    // Nombre de tuiles copiées parce qu'un instantané les gardait (depuis la création de la grille)
+    int getCopiedTileCount() const;
+
+    // Représentation des cases et modèle probabiliste
+    OccupancyMode getMode() const;
+    const LogOddsConfig& getLogOddsConfig() const;
 
-    // Retourne l'accès direct à la matrice brute (pour lecture ou modification avancée).
-    cv::Mat& getGrid();
+    // Retourne le log-odds de la case (gx, gy) de la grille (0 en mode BINARY)
+    int getLogOdds(int gx, int gy) const;
+
+    // Identifiant du contenu de la grille : différent pour chaque grille, et renouvelé quand ses
+    // cases changent en dehors des scans (setCells(), changement de mode).
+    // Un scan déjà appliqué au même identifiant n'a pas à être réappliqué (voir Lidar::scanAndMap()).
+    uint64_t getContentId() const;
 
 private:
+    friend class OccupancySnapshot; // Lit les tuiles partagées
+
     // --- MEMBRES ---
     
     int width;    // Largeur réelle de l'environnement (pixels)
@@ -53,7 +245,212 @@ private:
     int gridW;    // Largeur de la grille (nombre de colonnes)
     int gridH;    // Hauteur de la grille (nombre de lignes)
     
-    cv::Mat grid; // Matrice OpenCV stockant les valeurs (0, 127, 255)
+    // --- STOCKAGE PAR TUILES ---
+    static const int TILE_SHIFT = 6;                // log2(TILE_SIZE)
+    static const int TILE_SIZE = 1 << TILE_SHIFT;   // Côté d'une tuile (cases) : 4 Ko de cases par tuile
+    static const int TILE_MASK = TILE_SIZE - 1;
+    static const int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+    // Cases d'une tuile, ligne par ligne (TILE_SIZE cases par ligne, même en bord de grille)
+    struct Tile {
+        uchar cells[TILE_CELLS];      // Valeurs (0, 127, 255)
+        std::vector<int16_t> logOdds; // Log-odds de chaque case (mode LOG_ODDS seulement)
+    };
+
+    int tilesX;                                   // Nombre de tuiles en largeur
+    int tilesY;                                   // Nombre de tuiles en hauteur
+    std::vector<Tile*> tiles;                     // Table des tuiles (&blankTile : absente, tout inconnu)
+    Tile blankTile;                               // Tuile inconnue partagée (jamais écrite)
+    std::vector<std::shared_ptr<Tile>> tileOwners;// Propriétaire de chaque tuile présente (partagé avec les instantanés)
+    std::vector<uchar> tileWritable;              // 1 si la tuile est présente et gardée par aucun instantané
+    std::vector<std::shared_ptr<Tile>> tilePool;  // Tuiles rendues, réutilisées avant d'en allouer
+    int allocatedTiles;                           // Tuiles présentes dans la table
+    uint64_t contentId;                           // Identifiant du contenu (voir getContentId())
+
+    // --- INSTANTANÉS ---
+    uint64_t snapshotSequence;                    // Numéro du dernier instantané publié
+    int copiedTiles;                              // Tuiles copiées à cause d'un instantané
+    std::shared_ptr<const OccupancySnapshot> latestSnapshot; // Dernier instantané publié
+    mutable std::mutex snapshotMutex;             // Protège latestSnapshot (copie du pointeur seulement)
+
+    RayStencil stencil;   // Cases traversées par chaque rayon du Lidar (voir useRayStencil())
+    int lastUpdateCells;  // Cases écrites par le dernier update()
+
+    int unknownCount;     // Cases à 127 (inconnues)
+    int freeCount;        // Cases à 255 (libres)
+    double explorationThreshold; // Ratio d'inconnu sous lequel l'exploration est terminée
+
+    // --- SUIVI DES ZONES MODIFIÉES (par tuile) ---
+    std::vector<uchar> renderDirty;   // 1 si la tuile a changé depuis le dernier draw()
+    std::vector<int> renderDirtyTiles;// Indices de ces tuiles
+    std::vector<uchar> smoothDirty;   // 1 si un obstacle est apparu dans la tuile depuis le dernier smoothGrid()
+    std::vector<int> smoothDirtyTiles;// Indices de ces tuiles
+    cv::Mat view;                     // Image de la grille (BGR, taille du monde), gardée entre deux draw()
+    int lastSmoothIterations;         // Itérations du dernier smoothGrid() (0 : jamais lissée)
+    // Pyramide : "mutable" car mise à jour par les requêtes de zone, qui restent const pour les appelants
+    mutable std::vector<uchar> pyramidDirty;   // 1 si la tuile a changé depuis la dernière mise à jour de la pyramide
+    mutable std::vector<int> pyramidDirtyTiles;// Indices de ces tuiles
+
+    // --- PYRAMIDE MULTI-RÉSOLUTION ---
+    mutable OccupancyPyramid pyramid; // États des cases agrégés par carrés de 2^k cases
+
+    // --- MODE PROBABILISTE ---
+    OccupancyMode mode;               // BINARY ou LOG_ODDS
+    LogOddsConfig logOddsConfig;      // Modèle demandé
+    LogOddsParams logOddsParams;      // Même modèle, converti pour les noyaux SIMD
+    SimdLevel simdLevel;              // Jeu d'instructions des noyaux (détecté au démarrage)
+    cv::Rect evidenceRect;            // Cases de la fenêtre du scan en cours (vide hors scan)
+    std::vector<uchar> evidence;      // Évidence de chaque case de la fenêtre (EVIDENCE_*)
+
+    // --- MÉTHODES PRIVÉES ---
+
+    // Indice de la tuile contenant la case (gx, gy), et position de la case dans la tuile
+    int tileIndex(int gx, int gy) const;
+    static int cellOffset(int gx, int gy);
+
+    // Tuile d'indice tile, pour y écrire : allouée (depuis la réserve si possible) si elle est
+    // absente, copiée si un instantané la garde
+    Tile* tileAt(int tile);
+
+    // Rend modifiable la tuile d'indice tile (hors du cas courant de tileAt())
+    Tile* prepareTile(int tile);
+
+    // Alloue la tuile d'indice tile : cases inconnues, log-odds nuls
+    Tile* allocateTile(int tile);
+
+    // Tuile vide : prise dans la réserve si possible
+    std::shared_ptr<Tile> newTile();
+
+    // Rend la tuile d'indice tile à la réserve (si aucun instantané ne la garde)
+    void releaseTile(int tile);
+
+    // Change l'état d'une case (tuile allouée si besoin, compteurs et tuiles modifiées tenus à jour).
+    // Hors de l'en-tête : markFree / markOccupied restent assez courts pour être "inlinés"
+    // dans la boucle du lancer de rayons, et une case change rarement d'état.
+    void setCell(int tile, int offset, uchar value);
+
+    // Copie les cases d'un rectangle de la grille dans out (CV_8UC1)
+    void copyCells(const cv::Rect& cells, cv::Mat& out) const;
+
+    // Marque la tuile d'indice tile comme à redessiner (et à lisser si obstacle est vrai)
+    void markTileDirty(int tile, bool obstacle);
+
+    // Marque toutes les tuiles (première image, modification directe de la grille)
+    void markAllDirty();
+
+    // Cases de la tuile d'indice tile
+    cv::Rect tileRect(int tile) const;
+
+    // Redessine les cases d'une tuile dans l'image gardée
+    void renderTile(int tile);
+
+    // Dessine dans view (BGR) les cases du rectangle 'rect' d'une tuile (cells : ses cases,
+    // TILE_SIZE par ligne), chaque case en cellSize x cellSize pixels (aussi pour OccupancySnapshot::draw())
+    static void renderCells(const uchar* cells, const cv::Rect& rect, int cellSize, cv::Mat& view);
+
+    // Met à jour la pyramide au-dessus des tuiles modifiées depuis la dernière requête
+    void refreshPyramid() const;
+
+    // Ajoute à found les états de la zone sous le nœud (nx, ny) du niveau 'level'
+    // (descente récursive de getRegionStates())
+    void collectRegionStates(int level, int nx, int ny, const cv::Rect& cells, uchar stopStates, uchar& found) const;
+
+    // Note l'évidence d'un scan pour la case (gx, gy) (mode LOG_ODDS)
+    void addEvidence(int gx, int gy, uchar kind);
+
+    // Applique les évidences de 'count' cases de la ligne gy à partir de x0 (log-odds, vue
+    // seuillée, compteurs, tuiles modifiées)
+    void applyEvidence(int gy, int x0, int count, const uchar* kinds);
 };
 
+// Définies dans l'en-tête pour être "inlinées" : appelées pour chaque case traversée
+// par chaque rayon du Lidar.
+inline bool OccupancyGrid::markFree(int x, int y) {
+    // Un seul test non signé par axe couvre à la fois les valeurs négatives et trop grandes
+    if (static_cast<unsigned>(x) >= static_cast<unsigned>(gridW * cellSize) ||
+        static_cast<unsigned>(y) >= static_cast<unsigned>(gridH * cellSize)) {
+        return false;
+    }
+    // Cas courant (1 case = 1 pixel) sans division
+    const int gx = (cellSize == 1) ? x : x / cellSize;
+    const int gy = (cellSize == 1) ? y : y / cellSize;
+    if (mode == OccupancyMode::LOG_ODDS) {
+        addEvidence(gx, gy, EVIDENCE_FREE);
+        return true;
+    }
+    const int tile = tileIndex(gx, gy);
+    const int offset = cellOffset(gx, gy);
+    // PROTECTION CRITIQUE : on ne remplace jamais un obstacle (0) par du vide.
+    // Une case déjà libre n'est pas réécrite : seule une case inconnue change d'état
+    // (et seule cette écriture peut allouer la tuile).
+    if (tiles[tile]->cells[offset] == 127) {
+        setCell(tile, offset, 255);
+    }
+    return true;
+}
+
+inline bool OccupancyGrid::markOccupied(int x, int y) {
+    if (static_cast<unsigned>(x) >= static_cast<unsigned>(gridW * cellSize) ||
+        static_cast<unsigned>(y) >= static_cast<unsigned>(gridH * cellSize)) {
+        return false;
+    }
+    const int gx = (cellSize == 1) ? x : x / cellSize;
+    const int gy = (cellSize == 1) ? y : y / cellSize;
+    if (mode == OccupancyMode::LOG_ODDS) {
+        addEvidence(gx, gy, EVIDENCE_HIT);
+        return true;
+    }
+    const int tile = tileIndex(gx, gy);
+    const int offset = cellOffset(gx, gy);
+    if (tiles[tile]->cells[offset] != 0) {
+        setCell(tile, offset, 0);
+    }
+    return true;
+}
+
+inline int OccupancyGrid::tileIndex(int gx, int gy) const {
+    return (gy >> TILE_SHIFT) * tilesX + (gx >> TILE_SHIFT);
+}
+
+inline int OccupancyGrid::cellOffset(int gx, int gy) {
+    return ((gy & TILE_MASK) << TILE_SHIFT) | (gx & TILE_MASK);
+}
+
+inline OccupancyGrid::Tile* OccupancyGrid::tileAt(int tile) {
+    // Première écriture dans la tuile, ou depuis le dernier instantané : allocation ou copie
+    // (hors du cas courant)
+    return tileWritable[tile] ? tiles[tile] : prepareTile(tile);
+}
+
+inline void OccupancyGrid::markTileDirty(int tile, bool obstacle) {
+    if (!renderDirty[tile]) {
+        renderDirty[tile] = 1;
+        renderDirtyTiles.push_back(tile);
+    }
+    if (obstacle && !smoothDirty[tile]) {
+        smoothDirty[tile] = 1;
+        smoothDirtyTiles.push_back(tile);
+    }
+    if (!pyramidDirty[tile]) {
+        pyramidDirty[tile] = 1;
+        pyramidDirtyTiles.push_back(tile);
+    }
+}
+
+inline void OccupancyGrid::addEvidence(int gx, int gy, uchar kind) {
+    const int ex = gx - evidenceRect.x;
+    const int ey = gy - evidenceRect.y;
+    if (static_cast<unsigned>(ex) < static_cast<unsigned>(evidenceRect.width) &&
+        static_cast<unsigned>(ey) < static_cast<unsigned>(evidenceRect.height)) {
+        // Une seule évidence par case et par scan : l'impact l'emporte sur la traversée
+        uchar& e = evidence[ey * evidenceRect.width + ex];
+        if (e < kind) {
+            e = kind;
+        }
+    } else {
+        // Hors d'un scan (ou hors de sa fenêtre) : appliquée tout de suite
+        applyEvidence(gy, gx, 1, &kind);
+    }
+}
+
 #endif // OCCUPANCYGRID_HPP
\ No newline at end of file
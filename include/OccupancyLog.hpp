@@ -0,0 +1,148 @@
+#ifndef OCCUPANCYLOG_HPP
+#define OCCUPANCYLOG_HPP
+
+#include <opencv2/opencv.hpp>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+class OccupancyGrid;
+class OccupancySnapshot;
+
+// Journal de l'évolution d'une grille d'occupation (fichier binaire compact).
+// Un enregistrement par tick : une image clé (toute la grille) tous les keyframeInterval ticks,
+// et entre deux images clés les seules cases qui ont changé depuis le tick précédent.
+// Seul l'état des cases est gardé (inconnu / libre / obstacle, comme OccupancyGrid::getGrid()),
+// pas les log-odds.
+//
+// Format (entiers en varint : 7 bits par octet, bit de poids fort = "octet suivant") :
+// - en-tête : "OGL1", largeur, hauteur et cellSize de la grille, keyframeInterval ;
+// - enregistrement : type ('K' image clé, 'D' changements), tick, taille des données, données.
+// Les cases sont numérotées ligne par ligne (gy * largeur + gx) et codées 0 (inconnu),
+// 1 (libre) ou 2 (obstacle) :
+// - image clé : plages de cases de même état, varint((longueur - 1) << 2 | code) ;
+// - changements : nombre de plages, puis pour chaque plage de cases consécutives devenues le
+//   même état : varint(écart depuis la fin de la plage précédente << 2 | code), varint(longueur - 1).
+// La taille de chaque enregistrement permet de sauter ses données : le lecteur indexe tout
+// le fichier à l'ouverture, sans rien décoder, puis repart de l'image clé la plus proche.
+
+// =========================================================
+// ÉCRITURE
+// =========================================================
+class OccupancyLogWriter {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    OccupancyLogWriter();
+    ~OccupancyLogWriter();
+
+    // Crée le fichier (écrasé s'il existe). keyframeInterval : ticks entre deux images clés.
+    // Retourne false (avec un message d'erreur) si le fichier ne peut pas être créé.
+    bool open(const std::string& path, int keyframeInterval = 100);
+
+    // Termine le fichier (appelée aussi par le destructeur)
+    void close();
+
+    // --- 2. ÉCRITURE ---
+
+    // Ajoute le tick suivant : état courant de la grille (à appeler entre deux scans).
+    // Publie un instantané de la grille (voir OccupancyGrid::publishSnapshot()) et ne compare
+    // avec le précédent que les tuiles modifiées entre les deux.
+    void writeTick(OccupancyGrid& grid);
+
+    // --- 3. GETTERS ---
+
+    bool isOpen() const;
+
+    // Nombre de ticks écrits, et octets écrits (en-tête compris)
+    int getTickCount() const;
+    size_t getBytesWritten() const;
+
+private:
+    // --- MEMBRES ---
+
+    std::ofstream out;
+    int keyframeInterval;
+    int tickCount;
+    size_t bytesWritten;
+    std::shared_ptr<const OccupancySnapshot> previous; // État du tick précédent
+
+    std::vector<uint8_t> payload;                       // Données de l'enregistrement en cours
+    std::vector<std::pair<int, uint8_t>> changes;       // (numéro, code) des cases changées
+    cv::Mat before, after;                              // Cases d'une tuile (deux ticks)
+
+    // --- MÉTHODES PRIVÉES ---
+
+    // Écrit l'en-tête du fichier (au premier tick, d'après la taille de la grille)
+    void writeHeader(const OccupancySnapshot& snapshot);
+
+    // Remplit payload : toute la grille (image clé), ou les cases changées depuis previous
+    void encodeKeyframe(const OccupancySnapshot& snapshot);
+    void encodeDelta(const OccupancySnapshot& snapshot);
+
+    // Écrit un enregistrement (type, tick, taille, payload)
+    void writeRecord(uint8_t type, int tick);
+};
+
+// =========================================================
+// LECTURE
+// =========================================================
+class OccupancyLogReader {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    OccupancyLogReader();
+
+    // Ouvre un journal et indexe ses enregistrements (un fichier tronqué s'arrête au dernier
+    // enregistrement complet). Retourne false (avec un message d'erreur) si le fichier n'est pas
+    // un journal de grille.
+    bool open(const std::string& path);
+
+    // --- 2. LECTURE ---
+
+    // Reconstruit la grille après le tick demandé (0..getTickCount()-1) : depuis l'état courant
+    // s'il est entre l'image clé la plus proche et ce tick, sinon depuis cette image clé.
+    // Retourne false si le tick n'existe pas ou si les données sont invalides.
+    bool seek(int tick);
+
+    // État de la grille au dernier tick lu (CV_8UC1 : 0 / 127 / 255, comme OccupancyGrid::getGrid())
+    const cv::Mat& getCells() const;
+
+    // --- 3. GETTERS ---
+
+    int getTickCount() const;
+    int getCurrentTick() const;  // -1 avant le premier seek()
+    int getGridWidth() const;
+    int getGridHeight() const;
+    int getCellSize() const;
+    int getKeyframeInterval() const;
+
+private:
+    // Position d'un enregistrement dans le fichier
+    struct Record {
+        uint8_t type;        // 'K' ou 'D'
+        std::streamoff data; // Début des données
+        size_t size;         // Taille des données (octets)
+    };
+
+    // --- MEMBRES ---
+
+    std::ifstream in;
+    int gridW;
+    int gridH;
+    int cellSize;
+    int keyframeInterval;
+    std::vector<Record> records; // Un enregistrement par tick
+    int currentTick;
+    cv::Mat cells;
+    std::vector<uint8_t> payload;
+
+    // --- MÉTHODES PRIVÉES ---
+
+    // Lit les données de l'enregistrement d'un tick et les applique à cells
+    bool apply(int tick);
+};
+
+#endif // OCCUPANCYLOG_HPP
@@ -0,0 +1,77 @@
+#ifndef OCCUPANCYPYRAMID_HPP
+#define OCCUPANCYPYRAMID_HPP
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// États présents dans une zone de la grille, combinables par OU
+// (une zone avec REGION_UNKNOWN contient au moins une case inconnue, etc.)
+const uchar REGION_UNKNOWN = 1;  // Case à 127
+const uchar REGION_FREE = 2;     // Case à 255
+const uchar REGION_OCCUPIED = 4; // Toute autre valeur (obstacle)
+
+// État d'une case (0 / 127 / 255) sous forme de drapeau REGION_*
+inline uchar regionStateOf(uchar cell) {
+    return (cell == 127) ? REGION_UNKNOWN : (cell == 255) ? REGION_FREE : REGION_OCCUPIED;
+}
+
+// La classe OccupancyPyramid garde des versions de plus en plus grossières d'une grille
+// d'occupation (voir OccupancyGrid::getRegionStates()).
+// Au niveau k (k >= 1), un nœud couvre un carré de 2^k x 2^k cases de la grille et vaut le OU
+// des états (REGION_*) de ces cases ; le niveau 0 est la grille elle-même (non stockée ici).
+// Le dernier niveau n'a qu'un nœud, qui couvre toute la grille.
+//
+// La pyramide est tenue à jour par zones : après un changement des cases d'un rectangle,
+// updateRegion() recalcule le niveau 1 depuis ces cases, puis chaque niveau depuis le
+// précédent (4 nœuds par nœud), seulement au-dessus du rectangle.
+// Un octet pour 4 cases au niveau 1 : environ 1/3 d'octet par case pour toute la pyramide.
+class OccupancyPyramid {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    // Crée une pyramide pour une grille de gridW x gridH cases, toutes inconnues
+    OccupancyPyramid(int gridW = 0, int gridH = 0);
+
+    // Change la taille de la grille ; toutes les cases redeviennent inconnues
+    void reset(int gridW, int gridH);
+
+    // --- 2. MISE À JOUR ---
+
+    // Recalcule les nœuds au-dessus du rectangle 'cells' (cases de la grille, coin en
+    // coordonnées paires, ex: une tuile de la grille). cellRows pointe sur la case (cells.x,
+    // cells.y), et les lignes sont espacées de 'stride' octets.
+    void updateRegion(const cv::Rect& cells, const uchar* cellRows, int stride);
+
+    // --- 3. GETTERS ---
+
+    // Nombre de niveaux stockés (le niveau 0, la grille, n'est pas compté)
+    int getLevels() const;
+
+    // Nombre de nœuds en largeur / hauteur du niveau 'level' (1..getLevels())
+    int getLevelWidth(int level) const;
+    int getLevelHeight(int level) const;
+
+    // États (REGION_*) du nœud (nx, ny) du niveau 'level' (1..getLevels())
+    uchar getStates(int level, int nx, int ny) const;
+
+    // Octets occupés par tous les niveaux
+    size_t getMemoryBytes() const;
+
+private:
+    // --- MEMBRES ---
+
+    int gridW; // Taille de la grille (cases)
+    int gridH;
+
+    // levels[k - 1] : nœuds du niveau k, ligne par ligne (levelW[k - 1] nœuds par ligne)
+    std::vector<std::vector<uchar>> levels;
+    std::vector<int> levelW;
+    std::vector<int> levelH;
+};
+
+// Définie dans l'en-tête pour être "inlinée" (descente dans la pyramide)
+inline uchar OccupancyPyramid::getStates(int level, int nx, int ny) const {
+    return levels[level - 1][static_cast<size_t>(ny) * levelW[level - 1] + nx];
+}
+
+#endif // OCCUPANCYPYRAMID_HPP
@@ -0,0 +1,44 @@
+#ifndef OCCUPANCYSIMD_HPP
+#define OCCUPANCYSIMD_HPP
+
+#include <cstdint>
+#include "LidarSimd.hpp" // SimdLevel, detectSimdLevel()
+
+// Noyaux SIMD de la grille d'occupation probabiliste (mode log-odds, voir OccupancyGrid).
+// Chaque case garde son log-odds en virgule fixe sur 16 bits signés. Un scan est d'abord
+// accumulé dans une fenêtre d'évidences (une valeur par case : rien, traversée, impact),
+// puis appliqué ligne par ligne : les cases d'une ligne sont contiguës en mémoire,
+// la mise à jour se fait donc 8 cases (SSE4) ou 16 cases (AVX2) à la fois, avec une
+// addition saturée suivie d'une limitation entre minValue et maxValue.
+
+// Évidence d'un scan pour une case (une seule par scan : l'impact l'emporte)
+const uint8_t EVIDENCE_NONE = 0; // Case non vue par ce scan
+const uint8_t EVIDENCE_FREE = 1; // Un rayon a traversé la case
+const uint8_t EVIDENCE_HIT = 2;  // Un rayon s'est arrêté sur un mur dans la case
+
+// Paramètres du modèle (valeurs en virgule fixe, voir LogOddsConfig)
+struct LogOddsParams {
+    int16_t hit;               // Ajouté sur un impact (> 0)
+    int16_t miss;              // Ajouté sur une traversée (< 0)
+    int16_t minValue;          // Borne basse (une case libre peut redevenir occupée rapidement)
+    int16_t maxValue;          // Borne haute
+    int16_t occupiedThreshold; // Log-odds à partir duquel la case est affichée comme obstacle (0)
+    int16_t freeThreshold;     // Log-odds à partir duquel (en dessous) la case est libre (255)
+};
+
+// Bilan des changements d'état affiché (0 / 127 / 255) d'une ligne
+struct LogOddsRowChanges {
+    int unknown = 0;         // Variation du nombre de cases inconnues
+    int free = 0;            // Variation du nombre de cases libres
+    int changed = 0;         // Cases dont l'état affiché a changé
+    int obstacleChanges = 0; // Dont : cases devenues obstacle ou qui ne le sont plus
+};
+
+// Applique les évidences de 'count' cases consécutives :
+// logOdds[x] = clamp(logOdds[x] + delta(evidence[x]), minValue, maxValue), puis recalcule
+// state[x] (0 / 127 / 255) pour les cases vues, et ajoute les changements à 'changes'.
+// Si le processeur ne supporte pas 'level', la version SCALAR est utilisée.
+void applyLogOddsRow(SimdLevel level, int16_t* logOdds, uint8_t* state, const uint8_t* evidence,
+                     int count, const LogOddsParams& params, LogOddsRowChanges& changes);
+
+#endif // OCCUPANCYSIMD_HPP
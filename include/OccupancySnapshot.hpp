@@ -0,0 +1,96 @@
+#ifndef OCCUPANCYSNAPSHOT_HPP
+#define OCCUPANCYSNAPSHOT_HPP
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "OccupancyGrid.hpp"
+
+// La classe OccupancySnapshot est une vue figée d'une OccupancyGrid, publiée par le thread qui
+// met la grille à jour (OccupancyGrid::publishSnapshot()) et lue par n'importe quel thread
+// (affichage, planification, export) sans verrou : rien de ce qu'elle contient ne change après
+// sa publication.
+//
+// L'instantané ne copie pas les cases : il garde les tuiles de la grille telles qu'elles
+// étaient (copie sur écriture). La grille ne modifie jamais une tuile qu'un instantané garde :
+// à sa première écriture après la publication, elle en fait une copie à elle. Un instantané
+// coûte donc une copie de la table des tuiles, puis une copie de chaque tuile modifiée avant
+// la publication suivante ; la mise à jour n'attend jamais un lecteur, et un lecteur ne voit
+// jamais un scan à moitié appliqué.
+class OccupancySnapshot {
+public:
+    // --- 1. CASES ---
+
+    // État (0 / 127 / 255) de la case (gx, gy) (127 hors de la grille)
+    uchar getCell(int gx, int gy) const;
+
+    // Log-odds de la case (gx, gy) (0 en mode BINARY ou hors de la grille)
+    int getLogOdds(int gx, int gy) const;
+
+    // Copie les cases d'un rectangle de la grille dans out (CV_8UC1), ou toute la grille
+    void copyRegion(const cv::Rect& cells, cv::Mat& out) const;
+    void copyTo(cv::Mat& out) const;
+
+    // Dessine la grille dans view (BGR, taille du monde, comme OccupancyGrid::draw()).
+    // previous : instantané déjà dessiné dans view (même grille, gardé en vie depuis) : seules
+    // les tuiles qui ont changé depuis sont redessinées. nullptr (ou view d'une autre taille) :
+    // toute la grille.
+    void draw(cv::Mat& view, const OccupancySnapshot* previous) const;
+
+    // --- 2. TUILES (Comparaison de deux instantanés) ---
+
+    // Nombre de tuiles et cases de la tuile d'indice tile
+    int getTileCount() const;
+    cv::Rect getTileRect(int tile) const;
+
+    // Vrai si la tuile d'indice tile est la même dans les deux instantanés (d'une même grille) :
+    // aucune case de la tuile n'a changé entre les deux publications
+    bool sameTile(const OccupancySnapshot& other, int tile) const;
+
+    // --- 3. GETTERS ---
+
+    // Numéro de publication (1 pour le premier instantané d'une grille, puis croissant)
+    uint64_t getSequence() const;
+
+    // Taille de la grille (cases) et facteur d'échelle (1 case = cellSize pixels)
+    int getGridWidth() const;
+    int getGridHeight() const;
+    int getCellSize() const;
+
+    // Taille du monde (pixels) : taille de l'image de draw()
+    int getWidth() const;
+    int getHeight() const;
+
+    // Représentation des cases au moment de la publication
+    OccupancyMode getMode() const;
+
+    // Nombre de cases de chaque état au moment de la publication
+    int getUnknownCount() const;
+    int getFreeCount() const;
+    int getOccupiedCount() const;
+    double getUnknownRatio() const;
+
+private:
+    friend class OccupancyGrid; // Seule la grille construit ses instantanés
+
+    OccupancySnapshot() = default;
+
+    // --- MEMBRES ---
+
+    uint64_t sequence = 0;
+    int gridW = 0;
+    int gridH = 0;
+    int cellSize = 1;
+    int width = 0;    // Taille du monde (pixels)
+    int height = 0;
+    int tilesX = 0;
+    OccupancyMode mode = OccupancyMode::BINARY;
+    int unknownCount = 0;
+    int freeCount = 0;
+
+    // Tuiles partagées avec la grille (nullptr : tuile absente, toutes les cases inconnues)
+    std::vector<std::shared_ptr<const OccupancyGrid::Tile>> tiles;
+};
+
+#endif // OCCUPANCYSNAPSHOT_HPP
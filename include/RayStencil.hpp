@@ -0,0 +1,97 @@
+#ifndef RAYSTENCIL_HPP
+#define RAYSTENCIL_HPP
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+class OccupancyGrid; // Déclaration anticipée (la grille mise à jour)
+
+// La classe RayStencil pré-calcule, pour chaque rayon du Lidar, la suite ordonnée des cases
+// traversées par le DDA jusqu'à la portée maximale (décalages par rapport au robot).
+// Le robot est toujours sur une position entière : cette suite ne dépend que de la direction
+// du rayon, jamais de la position, et se calcule donc une seule fois.
+//
+// Près du robot, les rayons voisins passent par les mêmes cases : les débuts communs des
+// suites sont fusionnés en un arbre (une case de chemin = un nœud, le parent est la case
+// précédente), et chaque case distincte reçoit un numéro, partagé par tous ses nœuds.
+// La mise à jour de la grille remonte chaque rayon depuis sa dernière case libre vers le robot,
+// s'arrête dès qu'elle rejoint un nœud déjà parcouru par ce scan, et n'écrit une case que si
+// aucun autre rayon ne l'a écrite pendant ce scan : chaque case libre est écrite une seule fois.
+class RayStencil {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    // Crée un pochoir vide (isReady() est faux tant que reset() et addRay() n'ont pas été appelés)
+    RayStencil();
+
+    // --- 2. CONSTRUCTION (voir Lidar::buildRayStencil()) ---
+
+    // Vide le pochoir et prépare numRays rayons.
+    // rotatable : tourner le robot d'un quart de tour revient à décaler les rayons de numRays/4
+    void reset(int numRays, double maxRange, bool rotatable);
+
+    // Ajoute le rayon suivant (dans l'ordre des indices) : cases traversées depuis le robot
+    // (décalages, case du robot comprise) et distance d'entrée du DDA dans chaque case
+    void addRay(const std::vector<cv::Point>& cells, const std::vector<double>& entryDist);
+
+    // --- 3. MISE À JOUR DE LA GRILLE ---
+
+    // Marque les cases libres (avant chaque impact) et les murs touchés d'un scan.
+    // origin : position du robot ; quarter : orientation en quarts de tour (0 si non rotatable) ;
+    // ranges : distance mesurée par chaque rayon. Retourne le nombre de cases écrites (dans la grille).
+    int apply(OccupancyGrid& grid, cv::Point origin, int quarter, const std::vector<double>& ranges);
+
+    // Décompose une orientation en quarts de tour ; retourne false si ce n'en est pas un multiple exact
+    static bool quarterOf(double orientation, int& quarter);
+
+    // --- 4. GETTERS ---
+
+    // Retourne vrai si tous les rayons ont été ajoutés
+    bool isReady() const;
+
+    // Retourne le nombre de rayons du pochoir
+    int getRayCount() const;
+
+    // Retourne vrai si les 4 orientations du robot peuvent utiliser ce pochoir
+    bool isRotatable() const;
+
+    // Retourne le nombre de nœuds de l'arbre (cases après fusion des débuts communs)
+    int getNodeCount() const;
+
+    // Retourne le nombre de cases distinctes couvertes par les rayons
+    int getCellCount() const;
+
+    // Retourne la somme des longueurs de tous les rayons (cases avant fusion)
+    int getPathCellCount() const;
+
+private:
+    // --- MEMBRES ---
+    int numRays;       // Nombre de rayons attendus
+    double maxRange;   // Portée maximale (pas de mur touché au-delà)
+    bool rotatable;    // Les 4 orientations sont des décalages de numRays/4 rayons
+
+    // Arbre des cases (un nœud par case distincte d'un début de rayon ; le parent d'un nœud est
+    // la case précédente du rayon, c'est-à-dire le nœud précédent dans rayNodes)
+    std::vector<cv::Point> nodeOffset; // Décalage de la case par rapport au robot
+    std::vector<int> nodeChildren;     // 4 enfants par nœud (+X, -X, +Y, -Y), -1 si absent (construction)
+    std::vector<int> nodeCell;         // Numéro de la case distincte du nœud
+    std::vector<unsigned> nodeStamp;   // Numéro du dernier scan qui a parcouru ce nœud
+
+    // Cases distinctes
+    std::vector<unsigned> cellStamp;   // Numéro du dernier scan qui a écrit cette case
+    std::vector<int> cellLookup;       // Numéro de chaque décalage du carré de la portée, -1 si
+                                       // aucun (construction)
+    int lookupRadius;                  // Demi-côté du carré de cellLookup
+
+    // Rayons : les nœuds et distances du rayon r sont aux indices [rayStart[r], rayStart[r + 1][
+    std::vector<int> rayStart;
+    std::vector<int> rayNodes;         // Nœud de chaque case du rayon, du robot vers la portée
+    std::vector<double> rayDist;       // Distance d'entrée du DDA dans chaque case
+
+    unsigned currentStamp; // Numéro du scan en cours d'application
+
+    // Numéro de la case distincte d'un décalage (construction)
+    int cellIdOf(cv::Point offset);
+};
+
+#endif // RAYSTENCIL_HPP
@@ -0,0 +1,133 @@
+#ifndef SCANCACHE_HPP
+#define SCANCACHE_HPP
+
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <opencv2/opencv.hpp>
+
+// Compteurs du cache des scans (voir Lidar::getScanCacheStats())
+struct ScanCacheStats {
+    long long hits = 0;        // Scans servis par le cache (rotations comprises)
+    long long rotatedHits = 0; // Dont : scans obtenus en tournant un scan d'une autre orientation
+    long long misses = 0;      // Poses absentes du cache (rayons lancés)
+    long long evictions = 0;   // Scans retirés pour respecter la limite mémoire
+    size_t entries = 0;        // Nombre de poses actuellement en cache
+    size_t bytes = 0;          // Mémoire occupée par ces poses (estimation)
+};
+
+// La classe ScanCache garde les distances des derniers scans, indexées par la pose du robot.
+// La carte est statique et le robot se déplace sur des positions entières avec 4 orientations :
+// un scan calculé une fois reste valable à chaque retour sur la même pose.
+//
+// - Les distances sont quantifiées sur 16 bits (pas de maxRange / 65535) : 2 octets par rayon.
+//   Une distance au-delà de la portée est ramenée à maxRange (rayon sans contact).
+// - Quand l'éventail est symétrique (tour complet, nombre de rayons multiple de 4), les 4
+//   orientations d'une même position partagent une seule entrée : le scan est rangé dans
+//   l'orientation 0 et tourner d'un quart de tour revient à décaler les indices de numRays/4.
+// - Le cache est borné en mémoire : la pose utilisée le moins récemment est retirée (LRU).
+class ScanCache {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    // Crée un cache vide (maxBytes = 0 : cache désactivé)
+    explicit ScanCache(size_t maxBytes = 0);
+
+    // --- 2. CONFIGURATION ---
+
+    // Adapte le cache au modèle du capteur et le vide.
+    // rotatable : les 4 orientations sont des décalages exacts de numRays/4 rayons
+    void configure(int numRays, double maxRange, bool rotatable);
+
+    // Change la limite mémoire (0 = désactivé) ; retire les poses en trop
+    void setMemoryLimit(size_t maxBytes);
+
+    // Vide le cache (les compteurs sont conservés)
+    void clear();
+
+    // Remet à zéro les compteurs
+    void resetStats();
+
+    // --- 3. MÉTHODES PRINCIPALES ---
+
+    // Cherche le scan de la pose (position, quart de tour de l'orientation).
+    // Si elle est en cache, écrit les numRays distances dans 'ranges' et retourne true.
+    // mappedGrid (optionnel) : reçoit l'identifiant de la grille d'occupation à laquelle ce scan
+    // a été appliqué (OccupancyGrid::getContentId(), 0 : aucune).
+    bool lookup(cv::Point position, int quarter, double* ranges, uint64_t* mappedGrid = nullptr);
+
+    // Ajoute le scan d'une pose, puis remplace les distances de 'ranges' par leur valeur
+    // quantifiée (celle que rendra lookup()) : le résultat ne dépend pas de l'état du cache.
+    // mappedGrid : identifiant de la grille à laquelle le scan a été appliqué (0 : aucune,
+    // voir Lidar::scanAndMap()).
+    void insert(cv::Point position, int quarter, double* ranges, uint64_t mappedGrid = 0);
+
+    // Quantifie les distances sans les mettre en cache (pose non cachable),
+    // pour que tous les scans aient la même précision
+    void quantize(double* ranges) const;
+
+    // --- 4. GETTERS ---
+
+    // Retourne vrai si le cache est actif (limite mémoire non nulle)
+    bool isEnabled() const;
+
+    // Retourne les compteurs (taux de réussite, mémoire occupée)
+    ScanCacheStats getStats() const;
+
+private:
+    // --- TYPES ---
+
+    // Clé d'une pose : position + quart de tour (toujours 0 si l'éventail est symétrique)
+    struct PoseKey {
+        int x, y, quarter;
+        bool operator==(const PoseKey& other) const {
+            return x == other.x && y == other.y && quarter == other.quarter;
+        }
+    };
+    struct PoseKeyHash {
+        size_t operator()(const PoseKey& k) const {
+            uint64_t h = static_cast<uint32_t>(k.x);
+            h = h * 0x9E3779B97F4A7C15ULL + static_cast<uint32_t>(k.y);
+            h = h * 0x9E3779B97F4A7C15ULL + static_cast<uint32_t>(k.quarter);
+            return static_cast<size_t>(h ^ (h >> 29));
+        }
+    };
+
+    // Scan en cache (distances quantifiées, dans l'orientation de la clé)
+    struct Entry {
+        PoseKey key;
+        int quarter;                  // Orientation réelle du scan d'origine (pour les statistiques)
+        uint64_t mappedGrid;          // Grille à laquelle le scan a été appliqué (0 : aucune)
+        std::vector<uint16_t> ranges; // Distances quantifiées
+    };
+
+    // Code réservé à "rien touché" : toute distance < maxRange reste strictement en dessous
+    static const uint16_t CODE_MAX = 65535;
+
+    // --- MEMBRES ---
+    int numRays;          // Nombre de rayons du capteur
+    double maxRange;      // Portée maximale (distance du code CODE_MAX)
+    bool rotatable;       // Les 4 orientations partagent la même entrée
+    size_t maxBytes;      // Limite mémoire (0 = désactivé)
+    size_t entryBytes;    // Mémoire estimée d'une entrée
+
+    std::list<Entry> entries; // Poses, de la plus récemment utilisée à la plus ancienne
+    std::unordered_map<PoseKey, std::list<Entry>::iterator, PoseKeyHash> index; // Pose -> entrée
+    ScanCacheStats stats;
+
+    // --- MÉTHODES PRIVÉES ---
+
+    // Clé de la pose et décalage entre les indices du scan et ceux de l'entrée
+    PoseKey makeKey(cv::Point position, int quarter, int& shift) const;
+
+    // Conversion distance <-> code 16 bits
+    uint16_t encode(double range) const;
+    double decode(uint16_t code) const;
+
+    // Retire les poses les plus anciennes jusqu'à respecter la limite mémoire
+    void evict();
+};
+
+#endif // SCANCACHE_HPP
@@ -9,17 +9,79 @@
 #include "OccupancyGrid.hpp"
 #include "BehaviorManager.hpp"
 #include "ArucoManager.hpp"
+#include "ThreadPool.hpp"
+#include "InputLog.hpp"
+#include "OccupancyLog.hpp"
+#include "OccupancySnapshot.hpp"
+#include "TripleBuffer.hpp"
 #include <string>
 #include <random>
+#include <vector>
+#include <memory>
+
+// Entrée scriptée, appliquée au début d'un tick à la place des entrées en direct
+// (touche du clavier ou tag ArUco vu par la caméra)
+struct ScriptedEvent {
+    int tick;     // Tick auquel l'entrée est appliquée (0 = premier tick)
+    int key;      // Touche "appuyée" pendant ce tick (-1 : aucune)
+    int arucoId;  // Tag ArUco "détecté" pendant ce tick (-1 : aucun)
+};
+
+// État d'un tick, passé du thread de simulation au thread d'affichage (voir Simulation::runWindowed())
+struct FrameState {
+    int tick = 0;                                  // Ticks exécutés
+    Robot robot{cv::Point(0, 0)};                  // Robot à la fin du tick
+    LidarScan scan;                                // Scan du tick (rayons dessinés)
+    std::shared_ptr<const OccupancySnapshot> grid; // Grille à la fin du tick (instantané)
+    std::string behaviorName;                      // Mode affiché par le HUD de la caméra
+};
+
+// Options de lancement de la simulation (voir main.cpp pour la ligne de commande)
+struct SimulationOptions {
+    std::string mapPath = "map.png"; // Image de la carte
+    std::shared_ptr<const Map> map;  // Carte déjà chargée, partagée en lecture seule entre
+                                     // plusieurs simulations (prioritaire sur mapPath)
+
+    // Sans affichage : ni fenêtre ni caméra, et la boucle tourne aussi vite que le CPU le permet.
+    // Avec affichage, la simulation fait un tick tous les timestepMs sur son propre thread,
+    // quel que soit le temps de rendu du tableau de bord (voir runWindowed()).
+    bool headless = false;
+    int timestepMs = 30;             // Durée simulée d'un tick (ms)
+
+    // Conditions d'arrêt (en plus de la touche ESC)
+    int maxTicks = 0;                // Nombre maximal de ticks (0 : pas de limite)
+    bool untilExplored = false;      // Arrêt dès que la grille est explorée (OccupancyGrid::isFullyExplored())
+
+    // Entrées scriptées (dans n'importe quel ordre : elles sont triées par tick)
+    std::vector<ScriptedEvent> events;
+
+    // Exécution
+    int threads = 0;                 // Threads du Lidar, appelant compris (0 : un par cœur, 1 : en série)
+    unsigned seed = 0;               // Graine de la position de départ (0 : tirée au hasard, voir getSeed())
+    bool verbose = true;             // Messages console (instructions, changements de mode, bilan)
+
+    // Mesures de l'épisode : part de la grille explorée tous les coverageInterval ticks
+    // (0 : pas de courbe, voir getCoverageCurve())
+    int coverageInterval = 0;
+
+    // Enregistrement et rejeu (voir InputLog)
+    std::string recordPath;          // Journal des entrées à écrire (vide : pas d'enregistrement)
+    std::shared_ptr<const InputLogReader> replay; // Session à rejouer : sa graine, son pas de temps,
+                                     // ses entrées et son nombre de ticks remplacent ceux des options
+
+    // Journal de l'évolution de la grille, un enregistrement par tick (voir OccupancyLog)
+    std::string gridLogPath;         // Fichier à écrire (vide : pas de journal)
+    int gridLogKeyframeInterval = 100; // Ticks entre deux images clés du journal
+};
 
 // Classe principale gérant l'ensemble de la simulation
 class Simulation {
 public:
     // --- Constructeur ---
-    Simulation();
+    Simulation(const SimulationOptions& options = SimulationOptions());
 
     // --- Méthode Principale ---
-    // Lance la boucle infinie de la simulation
+    // Lance la boucle de la simulation, jusqu'à ESC ou une condition d'arrêt des options
     void run();
 
     // --- Getters (Accesseurs) ---
@@ -38,19 +100,132 @@ public:
     // Retourne une référence modifiable vers le robot 
     Robot& getRobotMutable();
 
+    // --- Mesures de l'épisode ---
+    // Nombre de ticks exécutés
+    int getTickCount() const;
+
+    // Premier tick où la grille était explorée (OccupancyGrid::isFullyExplored()), -1 sinon
+    int getExploredTick() const;
+
+    // Distance parcourue par le robot (pixels)
+    double getPathLength() const;
+
+    // Part de la grille explorée (0..1) au tick 0 puis tous les coverageInterval ticks
+    const std::vector<double>& getCoverageCurve() const;
+
+    // --- Reproductibilité ---
+    // Graine de la position de départ (celle des options, ou celle tirée au hasard)
+    unsigned getSeed() const;
+
+    // Empreinte (FNV-1a) de la trajectoire : position et orientation du robot après chaque tick
+    uint64_t getTrajectoryHash() const;
+
+    // Empreinte (FNV-1a) de toutes les cases de la grille (et de leurs log-odds)
+    uint64_t computeGridHash();
+
+    // Après run() en rejeu : vrai si la session rejouée est identique à l'enregistrement
+    // (mêmes changements de mode aux mêmes ticks, même nombre de ticks, mêmes empreintes)
+    bool isReplayIdentical() const;
+
+    // --- Mesures de l'affichage ---
+    // Images (cv::Mat) allouées pour composer le dernier tableau de bord, caméra comprise :
+    // seulement à la première image ou quand une taille change, 0 ensuite
+    int getLastFrameAllocations() const;
+
+    // Images allouées pour tous les tableaux de bord, et nombre de tableaux de bord affichés
+    uint64_t getFrameAllocationCount() const;
+    uint64_t getRenderedFrameCount() const;
+
 private:
     // --- Objets Composants la Simulation ---
-    Map map;                        // La carte de l'environnement 
+    ThreadPool threadPool;          // Threads de calcul persistants (créés une seule fois)
+    std::shared_ptr<const Map> map; // La carte de l'environnement (lecture seule, partageable)
     Robot robot;                    // Le robot qui se déplace
     Lidar lidar;                    // Le capteur de distance
     OccupancyGrid occupancyGrid;    // La carte construite par le robot 
     BehaviorManager behaviorManager;// Le gestionnaire de comportements 
     ArucoManager arucoManager;      // Le gestionnaire de détection des tags
 
+    // --- Données partagées du tick ---
+    LidarScan scan;                 // Scan Lidar du tick, calculé une seule fois par Simulation::run()
+
+    // --- Déroulement ---
+    SimulationOptions options;      // Options de lancement (événements triés par tick)
+    size_t nextEvent;               // Prochain événement scripté à appliquer
+    int tick;                       // Numéro du tick en cours
+
+    // --- Mesures de l'épisode ---
+    int exploredTick;               // Premier tick où la grille était explorée (-1 : jamais)
+    double pathLength;              // Distance parcourue (pixels)
+    std::vector<double> coverageCurve; // Part explorée tous les coverageInterval ticks
+
+    // --- Reproductibilité ---
+    unsigned seed;                  // Graine effective de la position de départ
+    uint64_t trajectoryHash;        // Empreinte de la trajectoire jusqu'au tick courant
+    InputLogWriter recorder;        // Journal des entrées (ouvert si options.recordPath)
+    OccupancyLogWriter gridLog;     // Journal de la grille (ouvert si options.gridLogPath)
+    std::vector<InputRecord> expectedModes; // Rejeu : changements de mode enregistrés
+    size_t nextExpectedMode;        // Rejeu : prochain changement de mode attendu
+    int divergenceTick;             // Rejeu : premier tick différent de l'enregistrement (-1 : aucun)
+    bool replayIdentical;           // Rejeu : résultat de la vérification finale
+
     // --- Variables d'Interface ---
     std::string windowName;         // Nom de la fenêtre d'affichage OpenCV
 
-    
+    // --- Mesures de l'affichage ---
+    int frameAllocations;           // Images allouées pour le dernier tableau de bord (0 en régime établi)
+    uint64_t totalFrameAllocations; // Images allouées pour tous les tableaux de bord
+    uint64_t renderedFrames;        // Tableaux de bord affichés
+    uint64_t seenCameraAllocations; // Allocations de la caméra déjà comptées
+    cv::Mat dashboard;              // Tableau de bord, gardé d'une image à l'autre (pas de réallocation)
+    cv::Mat simView;                // Zone "Simulation" du tableau de bord
+    cv::Mat memView;                // Zone "Mémoire" : grille mise à jour par tuiles, plus le robot
+    cv::Mat camView;                // Zone "Caméra" (écrite par ArucoManager::captureAndDetect())
+    std::shared_ptr<const OccupancySnapshot> drawnGrid; // Dernier instantané dessiné dans memView
+    cv::Mat robotPatch;             // Pixels de la grille sous le robot dessiné dans memView
+    cv::Rect robotPatchRect;        // Position de robotPatch dans memView (vide : rien à effacer)
+    TripleBuffer<FrameState> frames; // Images : thread de simulation -> thread d'affichage
+
+    // Exécute un tick avec les entrées reçues (-1 : aucune). Retourne false sur ESC.
+    bool runTick(int key, int markerId);
+
+    // Boucle avec affichage : simulation sur un thread de travail, caméra, clavier et tableau
+    // de bord sur le thread appelant (HighGUI n'est utilisable que depuis ce thread)
+    void runWindowed();
+
+    // Copie l'état du tick courant dans le tampon d'images et le publie (thread de simulation)
+    void publishFrame();
+
+    // Applique les événements scriptés du tick courant ; key reçoit la touche scriptée
+    // (inchangée s'il n'y en a pas)
+    void applyScriptedEvents(int& key);
+
+    // Exécute un tick : comportement, mouvement, scan et mise à jour de la grille
+    void step(int key);
+
+    // Compose et affiche le tableau de bord (simulation, grille, caméra) d'une image publiée
+    void renderDashboard(FrameState& frame);
+
+    // (Ré)alloue le tableau de bord et place ses trois zones (première image, ou changement de
+    // taille de la grille ou de la caméra)
+    void layoutDashboard(const cv::Size& gridSize, const cv::Size& camSize);
+
+    // Vrai si une condition d'arrêt des options est atteinte
+    bool shouldStop() const;
+
+    // Met à jour les mesures de l'épisode après un tick
+    void recordStats();
+
+    // Ajoute une entrée du tick courant au journal (si l'enregistrement est actif)
+    void recordInput(int key, int arucoId);
+
+    // Fin d'un tick : note le changement de mode dans le journal et, en rejeu, le compare à
+    // celui de l'enregistrement (before : comportement au début du tick)
+    void checkModeChange(int tickIndex, Behavior before);
+
+    // Fin de la session : termine le journal et, en rejeu, vérifie les empreintes
+    void finishSession();
+
     // Vérifie si une position donnée entraîne une collision avec un mur
     // centerPos : Le point central du robot à tester
     bool checkCollision(cv::Point centerPos) const;
@@ -0,0 +1,76 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+// La classe ThreadPool gère un groupe de threads de calcul persistants.
+// Les threads sont créés une seule fois (à la construction) puis réutilisés à chaque tick :
+// aucune création de thread dans la boucle de simulation.
+//
+// Le seul type de travail proposé est une boucle parallèle découpée en blocs ("chunks")
+// de taille fixe : chaque thread prend le prochain bloc libre jusqu'à ce qu'il n'en reste plus.
+// Le thread appelant participe au calcul, puis attend que tous les blocs soient terminés.
+class ThreadPool {
+public:
+    // --- 1. CONSTRUCTEUR / DESTRUCTEUR ---
+
+    // Crée le groupe de threads.
+    // numThreads : nombre total de threads de calcul, thread appelant compris
+    // (0 = autant que de cœurs disponibles, 1 = tout en série, aucun thread créé).
+    explicit ThreadPool(int numThreads = 0);
+
+    // Arrête et attend tous les threads
+    ~ThreadPool();
+
+    // Le groupe possède ses threads : ni copie ni déplacement
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // --- 2. MÉTHODES PRINCIPALES ---
+
+    // Exécute body(begin, end) sur tous les blocs [begin, end[ de [0, count[,
+    // chaque bloc faisant au plus chunkSize éléments. Retourne quand tout est terminé.
+    // S'il n'y a qu'un seul bloc (ou un seul thread), tout est fait en série par l'appelant.
+    // Un seul parallelFor à la fois par groupe (appels concurrents sérialisés).
+    void parallelFor(int count, int chunkSize, const std::function<void(int, int)>& body);
+
+    // --- 3. GETTERS ---
+
+    // Retourne le nombre total de threads de calcul (thread appelant compris)
+    int getThreadCount() const;
+
+private:
+    // --- MEMBRES ---
+    std::vector<std::thread> workers; // Threads persistants (hors thread appelant)
+
+    std::mutex submitMutex;           // Sérialise les appels à parallelFor()
+    std::mutex mutex;                 // Protège l'état du travail en cours
+    std::condition_variable wakeUp;   // Réveille les threads quand un travail arrive
+    std::condition_variable finished; // Prévient l'appelant quand les threads ont fini
+
+    // Travail en cours (valide tant que busyWorkers > 0 ou que l'appelant calcule)
+    const std::function<void(int, int)>* job; // Corps de la boucle
+    int jobCount;                     // Nombre total d'éléments
+    int jobChunk;                     // Taille d'un bloc
+    int numChunks;                    // Nombre de blocs
+    std::atomic<int> nextChunk;       // Prochain bloc à distribuer
+
+    unsigned long generation;         // Incrémenté à chaque nouveau travail
+    int busyWorkers;                  // Threads encore occupés sur le travail en cours
+    bool stopping;                    // Demande d'arrêt (destructeur)
+
+    // --- MÉTHODES PRIVÉES ---
+
+    // Boucle d'un thread persistant : attend un travail, prend des blocs, recommence
+    void workerLoop();
+
+    // Prend et exécute des blocs jusqu'à ce qu'il n'en reste plus
+    void runChunks();
+};
+
+#endif // THREADPOOL_HPP
@@ -0,0 +1,94 @@
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// La classe TripleBuffer fait passer des valeurs d'un thread producteur (la simulation) à un
+// thread consommateur (l'affichage) sans verrou et sans que l'un attende jamais l'autre.
+//
+// Trois emplacements : le producteur remplit le sien ("arrière"), le consommateur lit le sien
+// ("avant"), et le troisième ("milieu") contient la dernière valeur publiée. publish() échange
+// l'arrière et le milieu, update() échange le milieu et l'avant : chaque échange est une seule
+// opération atomique sur un octet (indice du milieu + drapeau "nouvelle valeur").
+// Si le consommateur est en retard, le producteur remplace la valeur publiée non lue :
+// le consommateur ne voit que la plus récente (valeurs intermédiaires abandonnées).
+//
+// Un seul producteur et un seul consommateur. Les emplacements sont réutilisés : une valeur
+// qui garde sa capacité (vecteurs, cv::Mat) ne réalloue rien d'un échange à l'autre.
+template <typename T>
+class TripleBuffer {
+public:
+    // --- 1. CONSTRUCTEUR ---
+
+    TripleBuffer()
+        : middle(1),
+          back(0),
+          front(2),
+          published(0),
+          dropped(0)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // --- 2. PRODUCTEUR ---
+
+    // Emplacement à remplir (à lui seul jusqu'au prochain publish())
+    T& getWriteBuffer() {
+        return slots[back];
+    }
+
+    // Publie l'emplacement rempli et en reprend un libre.
+    // La valeur publiée précédente est abandonnée si le consommateur ne l'a pas prise.
+    void publish() {
+        const uint8_t previous = middle.exchange(static_cast<uint8_t>(back | NEW_VALUE), std::memory_order_acq_rel);
+        back = previous & INDEX_MASK;
+        published.fetch_add(1, std::memory_order_relaxed);
+        if (previous & NEW_VALUE) {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // --- 3. CONSOMMATEUR ---
+
+    // Prend la dernière valeur publiée, s'il y en a une nouvelle depuis l'appel précédent.
+    // Retourne false (getReadBuffer() inchangé) sinon.
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & NEW_VALUE) == 0) {
+            return false;
+        }
+        const uint8_t previous = middle.exchange(front, std::memory_order_acq_rel);
+        front = previous & INDEX_MASK;
+        return true;
+    }
+
+    // Valeur prise par le dernier update() (à lui seul jusqu'au prochain update())
+    T& getReadBuffer() {
+        return slots[front];
+    }
+
+    // --- 4. GETTERS ---
+
+    // Valeurs publiées, et valeurs remplacées avant d'avoir été lues (lisibles de tout thread)
+    uint64_t getPublishedCount() const {
+        return published.load(std::memory_order_relaxed);
+    }
+    uint64_t getDroppedCount() const {
+        return dropped.load(std::memory_order_relaxed);
+    }
+
+private:
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t NEW_VALUE = 4;
+
+    T slots[3];
+    std::atomic<uint8_t> middle; // Indice du milieu | NEW_VALUE si publié et pas encore lu
+    uint8_t back;                // Indice de l'emplacement du producteur
+    uint8_t front;               // Indice de l'emplacement du consommateur
+    std::atomic<uint64_t> published;
+    std::atomic<uint64_t> dropped;
+};
+
+#endif // TRIPLEBUFFER_HPP
@@ -0,0 +1,50 @@
+#ifndef VARINT_HPP
+#define VARINT_HPP
+
+#include <vector>
+#include <istream>
+#include <cstdint>
+
+// Entiers non signés de taille variable (varint), partagés par les journaux (OccupancyLog, InputLog) :
+// 7 bits par octet, poids faible en premier, bit de poids fort = "un octet suit".
+// Une valeur < 128 tient en un seul octet.
+
+// Ajoute un entier non signé, 7 bits par octet (bit de poids fort : un octet suit)
+inline void putVarint(std::vector<uint8_t>& buffer, uint64_t value) {
+    while (value >= 0x80) {
+        buffer.push_back(static_cast<uint8_t>(value) | 0x80);
+        value >>= 7;
+    }
+    buffer.push_back(static_cast<uint8_t>(value));
+}
+
+// Lit un varint dans [pos, end) ; false s'il est tronqué
+inline bool getVarint(const uint8_t*& pos, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < end; shift += 7) {
+        const uint8_t byte = *pos++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Même chose depuis un flux (en-têtes lus sans charger le fichier)
+inline bool readVarint(std::istream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int byte = in.get();
+        if (byte == std::char_traits<char>::eof()) {
+            return false;
+        }
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#endif // VARINT_HPP
@@ -1,14 +1,26 @@
 #include "../include/ArucoManager.hpp"
 #include "../include/BehaviorManager.hpp" 
 #include <iostream>
+#include <algorithm>
 
 
 // =========================================================
 // CONSTRUCTEUR
 // =========================================================
-ArucoManager::ArucoManager(BehaviorManager* behaviorMgr) 
-    : behaviorManager(behaviorMgr) // Initialise le pointeur vers le gestionnaire de comportement
+ArucoManager::ArucoManager(BehaviorManager* behaviorMgr, bool useCamera) 
+    : behaviorManager(behaviorMgr), // Initialise le pointeur vers le gestionnaire de comportement
+      detectedId(-1),                // Aucun tag vu
+      allocationCount(0)
 {
+    // Mode sans affichage : pas de caméra (captureAndDetect() ne fera rien)
+    if (!useCamera) {
+        return;
+    }
+
+    // Image de sortie, noire tant que rien n'est capturé (remplacée par setFrameBuffer())
+    currentFrame = cv::Mat::zeros(480, 640, CV_8UC3);
+    allocationCount++;
+
     // Tentative d'ouverture de la caméra (Index 0 = Webcam par défaut)
     // CAP_V4L2 est l'API "Video for Linux 2", souvent plus stable sous Linux
     cap.open(0, cv::CAP_V4L2);
@@ -22,9 +34,8 @@ ArucoManager::ArucoManager(BehaviorManager* behaviorMgr)
 
     // Vérification si la caméra est bien accessible
     if (!cap.isOpened()) {
+        // Si erreur, l'image reste noire pour éviter le crash du programme
         std::cerr << "ERREUR CRITIQUE : Impossible d'ouvrir la caméra !" <<  std::endl;
-        // Si erreur, on crée une image noire vide pour éviter le crash du programme
-        currentFrame = cv::Mat::zeros(480, 640, CV_8UC3);
     } else {
          std::cout << "Camera initialisee (V4L2 + MJPG)." << std::endl;
     }
@@ -50,13 +61,19 @@ ArucoManager::~ArucoManager() {
 // =========================================================
 // MÉTHODE PRINCIPALE : CAPTURE ET DETECTION
 // =========================================================
-void ArucoManager::captureAndDetect() {
+void ArucoManager::captureAndDetect(const std::string& modeName) {
+    detectedId = -1;
+
     // Si pas de caméra, on ne fait rien
     if (!cap.isOpened()) return;
 
-    cv::Mat rawFrame;
     // Capture d'une nouvelle frame depuis le flux vidéo
+    // (rawFrame est gardée : OpenCV réutilise son buffer tant que la taille ne change pas)
+    const uchar* rawBefore = rawFrame.data;
     cap >> rawFrame;
+    if (rawFrame.data && rawFrame.data != rawBefore) {
+        allocationCount++;
+    }
 
     // Vérification si la frame est valide (parfois les premières frames sont vides)
     if (rawFrame.empty()) {
@@ -64,13 +81,13 @@ void ArucoManager::captureAndDetect() {
         return;
     }
 
-    // On clone l'image brute pour travailler dessus sans modifier le buffer interne de la caméra
-    currentFrame = rawFrame.clone();
-
-    // Préparation des conteneurs pour les résultats de la détection
-    std::vector<int> ids; // Liste des IDs trouvés (ex: [0, 5])
-    std::vector<std::vector<cv::Point2f>> corners; // Coordonnées des 4 coins pour chaque tag trouvé
-    std::vector<std::vector<cv::Point2f>> rejected; // Candidats rejetés (bruit, formes carrées non valides)
+    // On copie l'image brute dans l'image de sortie pour dessiner dessus sans modifier le buffer
+    // interne de la caméra (copie sur place : réallocation seulement si la taille change)
+    const uchar* frameBefore = currentFrame.data;
+    rawFrame.copyTo(currentFrame);
+    if (currentFrame.data != frameBefore) {
+        allocationCount++;
+    }
 
     // Lancement de l'algorithme de détection ArUco
     cv::aruco::detectMarkers(rawFrame, dictionary, corners, ids, parameters, rejected);
@@ -81,35 +98,45 @@ void ArucoManager::captureAndDetect() {
         cv::aruco::drawDetectedMarkers(currentFrame, corners, ids);
 
         // On prend le premier tag détecté pour piloter le robot
+        // (la simulation l'applique au BehaviorManager depuis son propre thread)
         int id = ids[0]; 
-
-        // Si le pointeur vers BehaviorManager est valide, on lui envoie l'ordre
-        if (behaviorManager) {
-            // Cette méthode va changer l'état du robot (Manuel vs Auto) selon l'ID
-            behaviorManager->setByArucoId(id);
-        }
+        detectedId = id;
 
         // Dessine l'interface utilisateur (HUD) avec l'ID détecté
-        drawOverlay(currentFrame, id);
+        drawOverlay(currentFrame, id, modeName);
     } else {
         // Aucun tag vu : on dessine quand même l'interface (avec ID = -1)
-        drawOverlay(currentFrame, -1); 
+        drawOverlay(currentFrame, -1, modeName); 
+    }
+}
+
+// Fait écrire les images suivantes dans buffer (ex: zone caméra du tableau de bord)
+void ArucoManager::setFrameBuffer(const cv::Mat& buffer) {
+    // L'image courante est gardée si elle a la même taille (sinon la zone reste telle quelle
+    // jusqu'à la prochaine capture)
+    cv::Mat target = buffer;
+    if (target.size() == currentFrame.size() && target.type() == currentFrame.type() && target.data != currentFrame.data) {
+        currentFrame.copyTo(target);
+    }
+    currentFrame = target;
+}
+
+// Applique un tag (vu par la caméra ou scripté) au BehaviorManager
+void ArucoManager::injectMarker(int id) {
+    if (behaviorManager) {
+        behaviorManager->setByArucoId(id);
     }
 }
 
 // =========================================================
 // MÉTHODE PRIVÉE : DESSIN DE L'INTERFACE (HUD)
 // =========================================================
-void ArucoManager::drawOverlay(cv::Mat& img, int detectedId) {
-    // 1. Création d'un bandeau semi-transparent en haut de l'image
-    cv::Mat overlay = img.clone();
-    
-    // Dessine un rectangle noir plein sur le haut de l'image (hauteur 100px)
-    cv::rectangle(overlay, cv::Point(0, 0), cv::Point(img.cols, 100), cv::Scalar(0, 0, 0), cv::FILLED);
-    
-    // Fusionne le rectangle noir avec l'image originale
-    // alpha=0.4 (transparence), beta=0.6 (image originale)
-    cv::addWeighted(overlay, 0.4, img, 0.6, 0, img);
+void ArucoManager::drawOverlay(cv::Mat& img, int detectedId, const std::string& modeName) {
+    // 1. Bandeau semi-transparent en haut de l'image (hauteur 100px)
+    // Fusion d'un rectangle noir (alpha=0.4) avec l'image (beta=0.6) : revient à multiplier les
+    // pixels du bandeau par 0.6, sur place (seule la zone du bandeau est parcourue, sans copie)
+    cv::Mat banner = img(cv::Rect(0, 0, img.cols, std::min(100, img.rows)));
+    banner.convertTo(banner, -1, 0.6);
     
     // 2. Préparation du texte selon l'ID détecté
     std::string tagText;
@@ -127,10 +154,8 @@ void ArucoManager::drawOverlay(cv::Mat& img, int detectedId) {
     cv::putText(img, tagText, cv::Point(15, 30), 
             cv::FONT_HERSHEY_SIMPLEX, 0.7, tagColor, 2);
     
-    // 3. Affichage du Mode actuel du robot (via BehaviorManager)
-    if(behaviorManager) {
-        // Récupère le nom du mode (MANUEL, WALL FOLLOWING...)
-        std::string modeName = behaviorManager->getBehaviorName();
+    // 3. Affichage du Mode actuel du robot (nom fourni par la simulation : MANUEL, WALL FOLLOWING...)
+    if (!modeName.empty()) {
         std::string modeText = "MODE: " + modeName;
         
         // Choix de la couleur selon le mode pour bien visualiser
@@ -165,4 +190,14 @@ cv::Mat ArucoManager::getFrame() const {
         return cv::Mat::zeros(480, 640, CV_8UC3);
     }
     return currentFrame;
-}
\ No newline at end of file
+}
+
+// Retourne le nombre d'images allouées depuis la création
+uint64_t ArucoManager::getAllocationCount() const {
+    return allocationCount;
+}
+
+// Retourne le tag détecté à la dernière capture
+int ArucoManager::getDetectedId() const {
+    return detectedId;
+}
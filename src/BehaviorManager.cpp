@@ -17,7 +17,8 @@ BehaviorManager::BehaviorManager(Simulation* sim)
       stepCounter(0),                 // Compteur à 0
       FRONT_WALL_DISTANCE(7.0),       // Seuil de détection mur devant (px)
       SIDE_WALL_DISTANCE(9.0),        // Seuil de détection perte mur côté (px)
-      explorationCompleted(false)     // Exploration non finie
+      explorationCompleted(false),    // Exploration non finie
+      verbose(true)                   // Messages console actifs
 {
     // Rien d'autre à initialiser dans le corps du constructeur
 }
@@ -27,7 +28,7 @@ BehaviorManager::BehaviorManager(Simulation* sim)
 // =========================================================
 
 // Méthode centrale appelée à chaque frame pour déterminer le mouvement
-void BehaviorManager::execute(int& dx, int& dy, int key) {
+void BehaviorManager::execute(int& dx, int& dy, int key, const LidarScan& scan) {
     // Par défaut, aucun mouvement
     dx = 0;
     dy = 0;
@@ -41,7 +42,7 @@ void BehaviorManager::execute(int& dx, int& dy, int key) {
             
         case Behavior::WALL_FOLLOW:
             // Mode autonome IA
-            executeWallFollow(dx, dy);
+            executeWallFollow(dx, dy, scan);
             break;
             
         default:
@@ -66,19 +67,21 @@ void BehaviorManager::executeManual(int& dx, int& dy, int key) {
 }
 
 // Implémentation du mode WALL FOLLOW (L'IA du robot)
-void BehaviorManager::executeWallFollow(int& dx, int& dy) {
+void BehaviorManager::executeWallFollow(int& dx, int& dy, const LidarScan& scan) {
     
     // 1. VÉRIFICATION DE LA FIN D'EXPLORATION
     // On accède à la grille via la simulation
     const OccupancyGrid& grid = simulation->getOccupancyGrid();
     
     // Si on n'a pas encore fini, on vérifie si la grille est complète
-    // (Supposant que OccupancyGrid a une méthode isFullyExplored, sinon retirer cette partie)
+    // (Temps constant : la grille tient à jour son nombre de cases inconnues)
      if (!explorationCompleted && grid.isFullyExplored()) {
         explorationCompleted = true;
-        std::cout << "\n============================================================" << std::endl;
-        std::cout << " CARTE TOTALEMENT EXPLORÉE ! LE ROBOT S'ARRÊTE. " << std::endl;
-        std::cout << "============================================================\n" << std::endl;
+        if (verbose) {
+            std::cout << "\n============================================================" << std::endl;
+            std::cout << " CARTE TOTALEMENT EXPLORÉE ! LE ROBOT S'ARRÊTE. " << std::endl;
+            std::cout << "============================================================\n" << std::endl;
+        }
         
         // Arrêt du robot
         dx = 0; dy = 0;
@@ -92,16 +95,16 @@ void BehaviorManager::executeWallFollow(int& dx, int& dy) {
     
     
     // 2. LECTURE DES CAPTEURS
-    const Lidar& lidar = simulation->getLidar();
-    std::vector<double> distances = lidar.readAll(); // Récupère les 360 rayons
+    // Le scan du tick est fourni par la simulation : pas de nouveau balayage ici
     const Robot& robot = simulation->getRobot();
     
     double orientation = robot.getOrientation(); // Angle actuel du robot
     double speed = robot.getSpeed();             // Vitesse de déplacement
     
-    // Lecture des distances clés
-    double front = distances[180]; // Distance devant (index 180)
-    double right = distances[270]; // Distance droite (index 270)
+    // Lecture des distances clés, par angle relatif à l'avant du robot
+    // (indépendant du nombre de rayons et du champ de vision du Lidar)
+    double front = scan.rangeAt(FRONT_ANGLE); // Distance devant
+    double right = scan.rangeAt(RIGHT_ANGLE); // Distance à droite
     
     const double WALL_DETECTION_DISTANCE = 10.0; // Seuil pour trouver le premier mur
     
@@ -222,7 +225,7 @@ void BehaviorManager::setByArucoId(int arucoId) {
     // On ne reset que si le comportement change vraiment
     if (newBehavior != currentBehavior) {
         currentBehavior = newBehavior;
-        std::cout << ">>> CHANGEMENT COMPORTEMENT: " << getBehaviorName() << std::endl;
+        if (verbose) std::cout << ">>> CHANGEMENT COMPORTEMENT: " << getBehaviorName() << std::endl;
         
         // Réinitialise les compteurs de navigation pour partir proprement
         reset();
@@ -237,6 +240,10 @@ void BehaviorManager::reset() {
     // Note : On ne reset pas explorationCompleted pour garder la progression
 }
 
+void BehaviorManager::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
 // =========================================================
 // GETTERS
 // =========================================================
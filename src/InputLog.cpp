@@ -0,0 +1,224 @@
+#include "../include/InputLog.hpp"
+#include "../include/Varint.hpp"
+#include <iostream>
+#include <iterator>
+#include <cstring>
+
+// =========================================================
+// OUTILS (Drapeaux, entiers de 8 octets ; varints : voir Varint.hpp)
+// =========================================================
+static const char LOG_MAGIC[4] = { 'S', 'I', 'L', '1' };
+
+// Drapeaux d'un enregistrement
+static const uint8_t INPUT_KEY = 1;
+static const uint8_t INPUT_ARUCO = 2;
+static const uint8_t INPUT_MODE = 4;
+static const uint8_t INPUT_END = 0x80;
+
+// Entier de 8 octets, poids faible en premier
+static void putUint64(std::vector<uint8_t>& buffer, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        buffer.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+static bool getUint64(const uint8_t*& pos, const uint8_t* end, uint64_t& value) {
+    if (end - pos < 8) {
+        return false;
+    }
+    value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= static_cast<uint64_t>(*pos++) << (8 * i);
+    }
+    return true;
+}
+
+// =========================================================
+// ÉCRITURE
+// =========================================================
+InputLogWriter::InputLogWriter()
+    : lastTick(0),
+      bytesWritten(0)
+{
+}
+
+InputLogWriter::~InputLogWriter() {
+    out.close();
+}
+
+bool InputLogWriter::open(const std::string& path, unsigned seed, const std::string& mapPath, int timestepMs) {
+    out.close();
+    out.clear();
+    lastTick = 0;
+    bytesWritten = 0;
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "ERREUR : Impossible de creer le journal d'entrees '" << path << "'" << std::endl;
+        return false;
+    }
+
+    buffer.assign(LOG_MAGIC, LOG_MAGIC + 4);
+    putVarint(buffer, seed);
+    putVarint(buffer, static_cast<uint64_t>(timestepMs));
+    putVarint(buffer, mapPath.size());
+    buffer.insert(buffer.end(), mapPath.begin(), mapPath.end());
+    flushBuffer();
+    return true;
+}
+
+void InputLogWriter::write(const InputRecord& record) {
+    if (!out.is_open()) {
+        return;
+    }
+    buffer.clear();
+    putVarint(buffer, static_cast<uint64_t>(record.tick - lastTick));
+    const uint8_t flags = (record.key >= 0 ? INPUT_KEY : 0) | (record.arucoId >= 0 ? INPUT_ARUCO : 0) |
+                          (record.modeChanged ? INPUT_MODE : 0);
+    buffer.push_back(flags);
+    if (flags & INPUT_KEY) putVarint(buffer, static_cast<uint64_t>(record.key));
+    if (flags & INPUT_ARUCO) putVarint(buffer, static_cast<uint64_t>(record.arucoId));
+    if (flags & INPUT_MODE) buffer.push_back(static_cast<uint8_t>(static_cast<int>(record.behavior) + 1));
+    flushBuffer();
+    lastTick = record.tick;
+}
+
+void InputLogWriter::finish(int tickCount, uint64_t trajectoryHash, uint64_t gridHash) {
+    if (!out.is_open()) {
+        return;
+    }
+    buffer.clear();
+    putVarint(buffer, static_cast<uint64_t>(tickCount - lastTick));
+    buffer.push_back(INPUT_END);
+    putUint64(buffer, trajectoryHash);
+    putUint64(buffer, gridHash);
+    flushBuffer();
+    out.close();
+}
+
+void InputLogWriter::flushBuffer() {
+    out.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    bytesWritten += buffer.size();
+}
+
+bool InputLogWriter::isOpen() const {
+    return out.is_open();
+}
+
+size_t InputLogWriter::getBytesWritten() const {
+    return bytesWritten;
+}
+
+// =========================================================
+// LECTURE
+// =========================================================
+InputLogReader::InputLogReader()
+    : seed(0),
+      timestepMs(30),
+      complete(false),
+      tickCount(0),
+      trajectoryHash(0),
+      gridHash(0)
+{
+}
+
+bool InputLogReader::open(const std::string& path) {
+    records.clear();
+    complete = false;
+    tickCount = 0;
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "ERREUR : Impossible d'ouvrir le journal d'entrees '" << path << "'" << std::endl;
+        return false;
+    }
+    // Le journal est petit (quelques octets par entrée) : lu d'un bloc
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const uint8_t* pos = data.data();
+    const uint8_t* end = pos + data.size();
+
+    // En-tête
+    uint64_t seedValue, timestep, pathLength;
+    const bool magicOk = data.size() >= 4 && std::memcmp(pos, LOG_MAGIC, 4) == 0;
+    if (magicOk) {
+        pos += 4;
+    }
+    if (!magicOk || !getVarint(pos, end, seedValue) || !getVarint(pos, end, timestep) ||
+        !getVarint(pos, end, pathLength) || pathLength > static_cast<uint64_t>(end - pos) ||
+        seedValue > 0xFFFFFFFFu || timestep == 0 || timestep > 0x7FFFFFFF) {
+        std::cerr << "ERREUR : '" << path << "' n'est pas un journal d'entrees valide." << std::endl;
+        return false;
+    }
+    seed = static_cast<unsigned>(seedValue);
+    timestepMs = static_cast<int>(timestep);
+    mapPath.assign(reinterpret_cast<const char*>(pos), static_cast<size_t>(pathLength));
+    pos += pathLength;
+
+    // Enregistrements (un enregistrement incomplet en fin de fichier est ignoré)
+    int tick = 0;
+    while (pos < end) {
+        uint64_t gap, key = 0, id = 0;
+        if (!getVarint(pos, end, gap) || pos >= end || gap > 0x7FFFFFFF - static_cast<uint64_t>(tick)) {
+            break;
+        }
+        const uint8_t flags = *pos++;
+        if (flags & INPUT_END) {
+            if (!getUint64(pos, end, trajectoryHash) || !getUint64(pos, end, gridHash)) {
+                break;
+            }
+            tick += static_cast<int>(gap);
+            tickCount = tick;
+            complete = true;
+            break;
+        }
+        if (((flags & INPUT_KEY) && (!getVarint(pos, end, key) || key > 0x7FFFFFFF)) ||
+            ((flags & INPUT_ARUCO) && (!getVarint(pos, end, id) || id > 0x7FFFFFFF)) ||
+            ((flags & INPUT_MODE) && (pos >= end || *pos > 2))) {
+            break;
+        }
+        tick += static_cast<int>(gap);
+        InputRecord record;
+        record.tick = tick;
+        record.key = (flags & INPUT_KEY) ? static_cast<int>(key) : -1;
+        record.arucoId = (flags & INPUT_ARUCO) ? static_cast<int>(id) : -1;
+        record.modeChanged = (flags & INPUT_MODE) != 0;
+        record.behavior = record.modeChanged ? static_cast<Behavior>(*pos++ - 1) : Behavior::IDLE;
+        records.push_back(record);
+    }
+    if (!complete) {
+        tickCount = records.empty() ? 0 : records.back().tick + 1;
+    }
+    return true;
+}
+
+unsigned InputLogReader::getSeed() const {
+    return seed;
+}
+
+const std::string& InputLogReader::getMapPath() const {
+    return mapPath;
+}
+
+int InputLogReader::getTimestepMs() const {
+    return timestepMs;
+}
+
+const std::vector<InputRecord>& InputLogReader::getRecords() const {
+    return records;
+}
+
+bool InputLogReader::isComplete() const {
+    return complete;
+}
+
+int InputLogReader::getTickCount() const {
+    return tickCount;
+}
+
+uint64_t InputLogReader::getTrajectoryHash() const {
+    return trajectoryHash;
+}
+
+uint64_t InputLogReader::getGridHash() const {
+    return gridHash;
+}
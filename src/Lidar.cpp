@@ -1,118 +1,673 @@
 #include "../include/Lidar.hpp"
-#include "../include/Simulation.hpp" 
 #include "../include/Robot.hpp"
 #include "../include/Map.hpp"
+#include "../include/ThreadPool.hpp"
+#include "../include/OccupancyGrid.hpp"
+#include "../include/RayStencil.hpp"
 #include <cmath>
 #include <iostream>
+#include <algorithm>
 
 // Définition de PI si non fournie par le compilateur
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
+// =========================================================
+// ROTATION DES RAYONS
+// =========================================================
+
+// Décomposition de l'orientation du robot en quarts de tour + reste.
+// Les quarts de tour s'appliquent exactement (échange et changement de signe des
+// composantes), sans aucune erreur d'arrondi : pour les 4 orientations du robot, les
+// directions absolues sont exactement celles des tables.
+struct FanRotation {
+    int quarter;       // Nombre de quarts de tour (0 à 3)
+    bool exact;        // Vrai si l'orientation est un multiple de PI/2 (reste nul)
+    double cosR, sinR; // Rotation du reste (si exact est faux)
+};
+
+static FanRotation decomposeRotation(double orientation) {
+    FanRotation rot;
+    double quarters = std::round(orientation / (M_PI / 2.0));
+    double rest = orientation - quarters * (M_PI / 2.0);
+    rot.quarter = static_cast<int>(((static_cast<long>(quarters) % 4) + 4) % 4);
+    rot.exact = std::abs(rest) < 1e-12;
+    rot.cosR = rot.exact ? 1.0 : std::cos(rest);
+    rot.sinR = rot.exact ? 0.0 : std::sin(rest);
+    return rot;
+}
+
+// Tourne le vecteur relatif (c, s) d'un rayon pour obtenir sa direction absolue
+static inline void rotateRay(const FanRotation& rot, double c, double s, double& dirX, double& dirY) {
+    double x = c, y = s;
+    if (!rot.exact) {
+        x = c * rot.cosR - s * rot.sinR;
+        y = c * rot.sinR + s * rot.cosR;
+    }
+    switch (rot.quarter) {
+        case 1:  dirX = -y; dirY = x;  break; // +90 degrés
+        case 2:  dirX = -x; dirY = -y; break; // 180 degrés
+        case 3:  dirX = y;  dirY = -x; break; // -90 degrés
+        default: dirX = x;  dirY = y;  break;
+    }
+}
+
+// Boucles sur tout l'éventail de rayons.
+// N > 0 : nombre de rayons fixé à la compilation (résolutions courantes, bornes de boucle
+// constantes que le compilateur peut dérouler / vectoriser) ; N = 0 : nombre lu à l'exécution.
+template <int N>
+struct FanKernels {
+    // Directions absolues de tous les rayons
+    static void rotate(const FanRotation& rot, const double* c, const double* s, int count,
+                       double* dirX, double* dirY) {
+        const int n = (N > 0) ? N : count;
+        for (int i = 0; i < n; i++) {
+            rotateRay(rot, c[i], s[i], dirX[i], dirY[i]);
+        }
+    }
+
+    // Points d'impact : x = x0 + dist * cos(theta), y = y0 + dist * sin(theta)
+    static void endpoints(cv::Point pos, const double* ranges, const double* dirX, const double* dirY,
+                          int count, cv::Point* points) {
+        const int n = (N > 0) ? N : count;
+        for (int i = 0; i < n; i++) {
+            points[i].x = pos.x + static_cast<int>(ranges[i] * dirX[i]);
+            points[i].y = pos.y + static_cast<int>(ranges[i] * dirY[i]);
+        }
+    }
+
+    // Angles absolus et drapeaux de contact du scan
+    static void anglesAndHits(double orientation, const double* relAngle, const double* ranges,
+                              double maxRange, int count, double* angles, uchar* hits) {
+        const int n = (N > 0) ? N : count;
+        for (int i = 0; i < n; i++) {
+            angles[i] = orientation + relAngle[i];
+            hits[i] = (ranges[i] < maxRange) ? 1 : 0; // Touché avant la portée maximale
+        }
+    }
+};
+
+// Choix de la version spécialisée selon le nombre de rayons (1, 0.5 et 0.25 degré)
+#define LIDAR_DISPATCH_FAN(count, call)                                     \
+    switch (count) {                                                        \
+        case 360:  FanKernels<360>::call;  break;                           \
+        case 720:  FanKernels<720>::call;  break;                           \
+        case 1440: FanKernels<1440>::call; break;                           \
+        default:   FanKernels<0>::call;    break;                           \
+    }
+
 // =========================================================
 // CONSTRUCTEUR
 // =========================================================
-Lidar::Lidar(Simulation* simulation_)
-    : simulation(simulation_) // Stocke le pointeur vers l'environnement
+Lidar::Lidar(const Map* map_, const Robot* robot_, const LidarConfig& config_)
+    : map(map_),              // Carte à scanner
+      robot(robot_),          // Robot portant le capteur
+      mode(RaycastMode::DDA), // Le DDA reste l'algorithme de référence
+      simdLevel(detectSimdLevel()), // Meilleur jeu d'instructions du processeur
+      pool(nullptr),          // En série tant qu'aucun groupe de threads n'est fourni
+      rayStep(0.0)
 {
+    // Une configuration invalide laisse le modèle d'origine (360 rayons, 100 px)
+    if (!setConfig(config_)) {
+        buildTables();
+        scanCache.configure(config.numRays, config.maxRange, config.isFullCircle() && config.numRays % 4 == 0);
+    }
 }
 
 // =========================================================
-// MÉTHODE PRINCIPALE : LECTURE D'UN RAYON (ALGO DDA)
+// TABLES DES RAYONS
 // =========================================================
-double Lidar::read(int rayID) const {
-    // 1. Récupération des objets nécessaires
-    const Map& map = simulation->getMap();   // Accès à la carte (Murs)
-    const Robot& robot = simulation->getRobot(); // Accès au robot (Position)
+void Lidar::buildTables() {
+    const int n = config.numRays;
+    const bool full = config.isFullCircle();
 
-    // Dimensions de la carte pour éviter de sortir des limites
-    int width = map.getWidth();
-    int height = map.getHeight();
+    // Angle du premier rayon et écart entre deux rayons (voir LidarConfig)
+    double first;
+    if (full) {
+        rayStep = 2.0 * M_PI / n;
+        first = config.angleOffset - M_PI;
+    } else {
+        rayStep = (n > 1) ? config.fov / (n - 1) : 0.0;
+        first = config.angleOffset - ((n > 1) ? config.fov / 2.0 : 0.0);
+    }
+
+    rayAngle.resize(n);
+    rayCos.resize(n);
+    raySin.resize(n);
+    for (int i = 0; i < n; i++) {
+        rayAngle[i] = first + i * rayStep;
+    }
+
+    // Tour complet avec un nombre de rayons multiple de 4 : seul le premier quart est calculé,
+    // les trois autres en sont des rotations exactes d'un quart de tour.
+    // Tourner le robot de 90 degrés revient alors exactement à décaler les rayons de numRays/4.
+    const int computed = (full && n % 4 == 0) ? n / 4 : n;
+    for (int i = 0; i < computed; i++) {
+        rayCos[i] = std::cos(rayAngle[i]);
+        raySin[i] = std::sin(rayAngle[i]);
+    }
+    for (int i = computed; i < n; i++) {
+        int j = i - n / 4;
+        rayCos[i] = -raySin[j];
+        raySin[i] = rayCos[j];
+    }
+}
 
-    // 2. Position de départ du rayon (Centre du robot)
-    cv::Point robotPos = robot.getPosition();
+void Lidar::computeDirections(double orientation, std::vector<double>& dirX, std::vector<double>& dirY) const {
+    const int n = config.numRays;
+    dirX.resize(n);
+    dirY.resize(n);
+    FanRotation rot = decomposeRotation(orientation);
+    LIDAR_DISPATCH_FAN(n, rotate(rot, rayCos.data(), raySin.data(), n, dirX.data(), dirY.data()))
+}
+
+// =========================================================
+// MÉTHODE PRINCIPALE : LECTURE D'UN RAYON
+// =========================================================
+double Lidar::read(int rayID) const {
+    // 1. Position de départ du rayon (Centre du robot)
+    cv::Point robotPos = robot->getPosition();
     double startX = static_cast<double>(robotPos.x);
     double startY = static_cast<double>(robotPos.y);
 
-    // 3. Calcul de l'angle du rayon
-    double orientation = robot.getOrientation(); // Orientation du robot
-    
-    // L'angle du rayon = Angle du robot + Décalage du rayon (ex: -180 à +180)
-    // (rayID - num_rays / 2) centre le scan devant le robot
-    double rayAngle = orientation + (rayID - num_rays / 2) * (M_PI / 180.0);
+    // 2. Direction du rayon : vecteur de la table tourné de l'orientation du robot
+    // (exactement le même calcul que computeDirections())
+    FanRotation rot = decomposeRotation(robot->getOrientation());
+    double rayDirX, rayDirY;
+    rotateRay(rot, rayCos[rayID], raySin[rayID], rayDirX, rayDirY);
 
-    // Calcul du vecteur direction du rayon
-    double rayDirX = std::cos(rayAngle);
-    double rayDirY = std::sin(rayAngle);
+    // 3. Lancer du rayon avec l'algorithme choisi
+    return castRay(startX, startY, rayDirX, rayDirY);
+}
+
+double Lidar::castRay(double startX, double startY, double rayDirX, double rayDirY) const {
+    switch (mode) {
+        case RaycastMode::SPHERE_TRACING:
+            return castSphereTraced(startX, startY, rayDirX, rayDirY);
+        case RaycastMode::HIERARCHICAL:
+            return castHierarchical(startX, startY, rayDirX, rayDirY, config.maxRange);
+        default:
+            return castDDA(startX, startY, rayDirX, rayDirY, config.maxRange);
+    }
+}
+
+// =========================================================
+// OUTILS DU DDA
+// =========================================================
+
+// Distance du n-ième pas du DDA sur un axe : sideDist0 + n * deltaDist.
+// Calculée directement (et non par additions successives) : la valeur ne dépend que de n,
+// ce qui permet de reprendre un parcours à n'importe quel endroit avec exactement le même
+// résultat qu'un parcours complet.
+static inline double sideDistAt(double sideDist0, double deltaDist, int n) {
+    return sideDist0 + n * deltaDist;
+}
+
+// Nombre de pas du DDA sur un axe dont la distance est strictement inférieure à 'dist'
+// (inclusive = true : inférieure ou égale)
+static int countStepsBefore(double sideDist0, double deltaDist, double dist, bool inclusive = false) {
+    if (sideDist0 > dist || (!inclusive && sideDist0 == dist)) {
+        return 0;
+    }
+    // Estimation par division, puis correction exacte avec sideDistAt()
+    double estimate = std::min((dist - sideDist0) / deltaDist + 1.0, 1e9);
+    int n = static_cast<int>(estimate);
+    if (inclusive) {
+        while (n > 0 && sideDistAt(sideDist0, deltaDist, n - 1) > dist) n--;
+        while (sideDistAt(sideDist0, deltaDist, n) <= dist) n++;
+    } else {
+        while (n > 0 && sideDistAt(sideDist0, deltaDist, n - 1) >= dist) n--;
+        while (sideDistAt(sideDist0, deltaDist, n) < dist) n++;
+    }
+    return n;
+}
+
+// Paramètres constants d'un rayon pour le DDA (calculés une fois au lancement du rayon)
+struct DDARay {
+    int mapX0, mapY0;           // Case de départ
+    int stepX, stepY;           // Direction du pas (+1 ou -1) sur chaque axe
+    double deltaDistX;          // Distance pour traverser 1 case en X
+    double deltaDistY;          // Distance pour traverser 1 case en Y
+    double sideDistX;           // Distance jusqu'au premier côté vertical (X)
+    double sideDistY;           // Distance jusqu'au premier côté horizontal (Y)
+};
+
+// Initialise les paramètres du DDA pour un rayon partant de (startX, startY)
+static DDARay initDDARay(double startX, double startY, double rayDirX, double rayDirY) {
+    DDARay ray;
 
-    // --- ALGORITHME DDA (Digital Differential Analyzer) ---
-    // Cet algorithme permet de parcourir une grille case par case très rapidement.
-    
     // Calcul de la distance que le rayon doit parcourir pour traverser 1 unité en X ou en Y
     // (deltaDistX = distance hypoténuse pour avancer de 1 en X)
     // 1e30 est une valeur "infinie" pour éviter la division par zéro si rayDir est 0
-    double deltaDistX = (rayDirX == 0) ? 1e30 : std::abs(1.0 / rayDirX);
-    double deltaDistY = (rayDirY == 0) ? 1e30 : std::abs(1.0 / rayDirY);
-
-    // Coordonnées entières de la case actuelle dans la grille de la carte
-    int mapX = int(startX);
-    int mapY = int(startY);
+    ray.deltaDistX = (rayDirX == 0) ? 1e30 : std::abs(1.0 / rayDirX);
+    ray.deltaDistY = (rayDirY == 0) ? 1e30 : std::abs(1.0 / rayDirY);
 
-    // Variables pour l'algo de parcours
-    double sideDistX; // Distance jusqu'au prochain côté vertical (X)
-    double sideDistY; // Distance jusqu'au prochain côté horizontal (Y)
-    int stepX;        // Direction du pas en X (+1 ou -1)
-    int stepY;        // Direction du pas en Y (+1 ou -1)
+    // Coordonnées entières de la case de départ dans la grille de la carte
+    ray.mapX0 = int(startX);
+    ray.mapY0 = int(startY);
 
-    // 4. Initialisation des pas et des distances initiales (sideDist)
+    // Initialisation des pas et des distances initiales (sideDist)
     if (rayDirX < 0) {
-        stepX = -1; // Le rayon va vers la gauche
-        sideDistX = (startX - mapX) * deltaDistX;
+        ray.stepX = -1; // Le rayon va vers la gauche
+        ray.sideDistX = (startX - ray.mapX0) * ray.deltaDistX;
     } else {
-        stepX = 1;  // Le rayon va vers la droite
-        sideDistX = (mapX + 1.0 - startX) * deltaDistX;
+        ray.stepX = 1;  // Le rayon va vers la droite
+        ray.sideDistX = (ray.mapX0 + 1.0 - startX) * ray.deltaDistX;
     }
 
     if (rayDirY < 0) {
-        stepY = -1; // Le rayon va vers le haut (Y diminue)
-        sideDistY = (startY - mapY) * deltaDistY;
+        ray.stepY = -1; // Le rayon va vers le haut (Y diminue)
+        ray.sideDistY = (startY - ray.mapY0) * ray.deltaDistY;
     } else {
-        stepY = 1;  // Le rayon va vers le bas (Y augmente)
-        sideDistY = (mapY + 1.0 - startY) * deltaDistY;
+        ray.stepY = 1;  // Le rayon va vers le bas (Y augmente)
+        ray.sideDistY = (ray.mapY0 + 1.0 - startY) * ray.deltaDistY;
     }
-    
+    return ray;
+}
+
+// =========================================================
+// ALGORITHME DDA (Digital Differential Analyzer)
+// =========================================================
+
+// Visiteur vide : simple lancer de rayon (le compilateur supprime les appels)
+struct NoCellVisitor {
+    void freeCell(int, int) {}
+    void hitCell(int, int) {}
+};
+
+// Visiteur du scan fusionné : écrit directement dans la grille d'occupation
+struct GridCellVisitor {
+    OccupancyGrid& grid;
+    void freeCell(int x, int y) { grid.markFree(x, y); }
+    void hitCell(int x, int y) { grid.markOccupied(x, y); }
+};
+
+template <class Visitor>
+double Lidar::traverseDDA(double startX, double startY, double rayDirX, double rayDirY,
+                          double maxDist, double skipDist, Visitor& visitor) const {
+    // Dimensions de la carte pour détecter les sorties de carte
+    int width = map->getWidth();
+    int height = map->getHeight();
+
+    // Cet algorithme permet de parcourir une grille case par case très rapidement.
+    DDARay ray = initDDARay(startX, startY, rayDirX, rayDirY);
+
+    // 1. Reprise éventuelle du parcours : on saute tous les pas situés avant skipDist
+    // (l'appelant garantit que les cases correspondantes sont libres)
+    int nX = countStepsBefore(ray.sideDistX, ray.deltaDistX, skipDist); // Nombre de pas faits en X
+    int nY = countStepsBefore(ray.sideDistY, ray.deltaDistY, skipDist); // Nombre de pas faits en Y
+    int mapX = ray.mapX0 + ray.stepX * nX;
+    int mapY = ray.mapY0 + ray.stepY * nY;
+
     bool hit = false;       // A-t-on touché un mur ?
-    double distance = 0.0;  // Distance parcourue
+    double distance = 0.0;  // Distance parcourue (les pas sautés sont tous avant skipDist < maxDist)
+
+    visitor.freeCell(mapX, mapY); // Case de départ (celle du robot)
+
+    // 2. Boucle de lancer de rayon (DDA Loop)
+    while (!hit && distance < maxDist) {
+        // Distances jusqu'aux prochains côtés X et Y
+        double nextX = sideDistAt(ray.sideDistX, ray.deltaDistX, nX);
+        double nextY = sideDistAt(ray.sideDistY, ray.deltaDistY, nY);
 
-    // 5. Boucle de lancer de rayon (DDA Loop)
-    while (!hit && distance < max_range) {
         // On avance dans la direction la plus courte (X ou Y) pour atteindre la prochaine intersection
-        if (sideDistX < sideDistY) {
-            sideDistX += deltaDistX;     // On saute à la prochaine case X
-            mapX += stepX;               // On met à jour la coordonnée grille X
-            distance = sideDistX - deltaDistX; // Calcul de la vraie distance parcourue
+        if (nextX < nextY) {
+            nX++;                        // On saute à la prochaine case X
+            mapX += ray.stepX;           // On met à jour la coordonnée grille X
+            distance = nextX;            // Distance parcourue jusqu'à l'entrée dans la case
         } else {
-            sideDistY += deltaDistY;     // On saute à la prochaine case Y
-            mapY += stepY;               // On met à jour la coordonnée grille Y
-            distance = sideDistY - deltaDistY;
+            nY++;                        // On saute à la prochaine case Y
+            mapY += ray.stepY;           // On met à jour la coordonnée grille Y
+            distance = nextY;
         }
 
-        // Vérification 1 : Est-ce qu'on est sorti de la carte ?
-        if (mapX >= 0 && mapX < width && mapY >= 0 && mapY < height) {
-            // Vérification 2 : Est-ce que cette case est un obstacle ?
-            if (map.isObstacle(mapX, mapY)) {
-                hit = true; // Impact confirmé
+        // Est-ce que cette case est un obstacle ?
+        // Pas de test de limites ici : la bordure de garde de la Map est remplie de murs,
+        // un rayon qui sort de la carte s'arrête donc sur la première case hors carte.
+        if (map->isObstacle(mapX, mapY)) {
+            hit = true; // Impact confirmé
+
+            // Sortie de carte considérée comme un impact max
+            if (mapX < 0 || mapX >= width || mapY < 0 || mapY >= height) {
+                distance = maxDist;
+            } else if (distance < maxDist) {
+                visitor.hitCell(mapX, mapY);
             }
+        } else if (distance < maxDist) {
+            visitor.freeCell(mapX, mapY);
+        }
+    }
+
+    // Retourne la distance mesurée ou le max si rien n'a été touché
+    return (hit) ? distance : maxDist;
+}
+
+double Lidar::castDDA(double startX, double startY, double rayDirX, double rayDirY,
+                      double maxDist, double skipDist) const {
+    NoCellVisitor visitor;
+    return traverseDDA(startX, startY, rayDirX, rayDirY, maxDist, skipDist, visitor);
+}
+
+// =========================================================
+// ALGORITHME DDA HIÉRARCHIQUE (Saut des blocs vides)
+// =========================================================
+double Lidar::castHierarchical(double startX, double startY, double rayDirX, double rayDirY,
+                               double maxDist, double skipDist) const {
+    int width = map->getWidth();
+    int height = map->getHeight();
+
+    DDARay ray = initDDARay(startX, startY, rayDirX, rayDirY);
+
+    // Reprise éventuelle du parcours à skipDist, exactement comme castDDA()
+    int nX = countStepsBefore(ray.sideDistX, ray.deltaDistX, skipDist); // Nombre de pas faits en X
+    int nY = countStepsBefore(ray.sideDistY, ray.deltaDistY, skipDist); // Nombre de pas faits en Y
+    int mapX = ray.mapX0 + ray.stepX * nX;
+    int mapY = ray.mapY0 + ray.stepY * nY;
+    bool hit = false;
+    double distance = 0.0;
+
+    while (!hit && distance < maxDist) {
+        // 1. On cherche le plus grand bloc vide contenant la case courante (du bas vers le haut :
+        // près d'un mur, un seul test suffit pour savoir qu'il faut avancer case par case).
+        int level = 0;
+        while (level < Map::PYRAMID_LEVELS && !map->blockHasObstacle(level + 1, mapX, mapY)) {
+            level++;
+        }
+
+        // Pour ce bloc, on calcule le pas exact par lequel le DDA en sortirait.
+        // Si ce pas dépasse la portée, le DDA s'arrêterait dans le bloc : on réessaie
+        // avec le bloc vide du niveau inférieur.
+        int bestNX = -1, bestNY = -1;
+        double bestDist = 0.0;
+
+        for (; level >= 1; level--) {
+            // Première case hors du bloc sur chaque axe (coordonnées avec bordure de garde)
+            int blockSize = 1 << level;
+            int blockX = ((mapX + Map::GUARD) >> level) << level;
+            int blockY = ((mapY + Map::GUARD) >> level) << level;
+            int exitX = (ray.stepX > 0 ? blockX + blockSize : blockX - 1) - Map::GUARD;
+            int exitY = (ray.stepY > 0 ? blockY + blockSize : blockY - 1) - Map::GUARD;
+
+            // Nombre de pas depuis le départ pour atteindre ces cases
+            int exitNX = (exitX - ray.mapX0) * ray.stepX;
+            int exitNY = (exitY - ray.mapY0) * ray.stepY;
+
+            // Distances des pas qui font sortir du bloc par un côté X ou par un côté Y
+            double exitDistX = sideDistAt(ray.sideDistX, ray.deltaDistX, exitNX - 1);
+            double exitDistY = sideDistAt(ray.sideDistY, ray.deltaDistY, exitNY - 1);
+            double exitDist = std::min(exitDistX, exitDistY);
+
+            // Tous les pas intermédiaires doivent rester sous la portée
+            if (exitDist >= maxDist) {
+                continue;
+            }
+
+            // Le DDA fait un pas Y avant un pas X en cas d'égalité (nextX < nextY est faux) :
+            // un pas Y de distance dY précède un pas X de distance dX si et seulement si dY <= dX.
+            if (exitDistX < exitDistY) {
+                bestNX = exitNX;
+                bestNY = countStepsBefore(ray.sideDistY, ray.deltaDistY, exitDistX, true);
+            } else {
+                bestNX = countStepsBefore(ray.sideDistX, ray.deltaDistX, exitDistY);
+                bestNY = exitNY;
+            }
+            bestDist = exitDist;
+            break;
+        }
+
+        // 2. Avancée : saut jusqu'à la sortie du bloc vide, ou un pas classique du DDA
+        if (bestNX >= 0) {
+            nX = bestNX;
+            nY = bestNY;
+            mapX = ray.mapX0 + ray.stepX * nX;
+            mapY = ray.mapY0 + ray.stepY * nY;
+            distance = bestDist;
         } else {
-            // Sortie de carte considérée comme un impact max
+            double nextX = sideDistAt(ray.sideDistX, ray.deltaDistX, nX);
+            double nextY = sideDistAt(ray.sideDistY, ray.deltaDistY, nY);
+            if (nextX < nextY) {
+                nX++;
+                mapX += ray.stepX;
+                distance = nextX;
+            } else {
+                nY++;
+                mapY += ray.stepY;
+                distance = nextY;
+            }
+        }
+
+        // 3. Test de la case atteinte, exactement comme le DDA
+        if (map->isObstacle(mapX, mapY)) {
             hit = true;
-            distance = max_range;
+            if (mapX < 0 || mapX >= width || mapY < 0 || mapY >= height) {
+                distance = maxDist;
+            }
         }
     }
 
-    // Retourne la distance mesurée ou le max si rien n'a été touché
-    return (hit) ? distance : max_range;
+    return (hit) ? distance : maxDist;
+}
+
+// =========================================================
+// ALGORITHME SPHERE TRACING (Champ de distance)
+// =========================================================
+double Lidar::certifyFreeDistance(double startX, double startY, double rayDirX, double rayDirY,
+                                  double tubeRadius, double fromDist) const {
+    double t = fromDist; // Distance déjà parcourue en toute sécurité
+
+    while (t < config.maxRange) {
+        // Point courant du rayon et case qui le contient
+        double px = startX + t * rayDirX;
+        double py = startY + t * rayDirY;
+        int cellX = static_cast<int>(std::floor(px));
+        int cellY = static_cast<int>(std::floor(py));
+
+        // Le champ de distance garantit qu'aucun mur n'est à moins de (clearance - marge)
+        // du point courant : on peut sauter cette distance sans rien rater.
+        // Avec un tube, on garde en plus tubeRadius de marge sur les côtés du rayon.
+        double step = map->getClearance(cellX, cellY) - SPHERE_MARGIN - tubeRadius;
+
+        // Trop près d'un mur pour sauter : on finit case par case
+        if (step < 1.0) {
+            break;
+        }
+        t += step;
+    }
+    return std::min(t, config.maxRange);
+}
+
+double Lidar::castSphereTraced(double startX, double startY, double rayDirX, double rayDirY) const {
+    // On reprend le DDA exactement là où le Sphere Tracing s'est arrêté : toutes les cases
+    // avant sont libres, le résultat est donc identique à celui d'un DDA complet.
+    double t = certifyFreeDistance(startX, startY, rayDirX, rayDirY, 0.0);
+    return castDDA(startX, startY, rayDirX, rayDirY, config.maxRange, t);
+}
+
+// =========================================================
+// MODE INCRÉMENTAL (Réutilisation du scan précédent)
+// =========================================================
+
+// Décalage d'indice entre les rayons de deux orientations du robot :
+// le rayon i dans la nouvelle orientation a la direction du rayon (i + shift) de l'ancienne.
+// Retourne false si les deux éventails n'ont pas les mêmes directions.
+static bool directionShift(const LidarConfig& config, double oldOrientation, double newOrientation, int& shift) {
+    if (oldOrientation == newOrientation) {
+        shift = 0;
+        return true;
+    }
+    // Quarts de tour exacts : les tables sont symétriques (voir buildTables())
+    FanRotation oldRot = decomposeRotation(oldOrientation);
+    FanRotation newRot = decomposeRotation(newOrientation);
+    if (!oldRot.exact || !newRot.exact || !config.isFullCircle() || config.numRays % 4 != 0) {
+        return false;
+    }
+    shift = (((newRot.quarter - oldRot.quarter) % 4 + 4) % 4) * (config.numRays / 4);
+    return true;
+}
+
+void Lidar::castIncremental(const std::vector<double>& dirX, const std::vector<double>& dirY,
+                            std::vector<double>& ranges) const {
+    const int n = config.numRays;
+    cv::Point pos = robot->getPosition();
+    double orientation = robot->getOrientation();
+    double startX = static_cast<double>(pos.x);
+    double startY = static_cast<double>(pos.y);
+
+    // 1. Vérification : le robot est-il resté dans le tube garanti autour des anciens rayons ?
+    cv::Point moved = pos - incremental.origin;
+    double movedDist = std::sqrt(static_cast<double>(moved.x * moved.x + moved.y * moved.y));
+    int shift = 0;
+    bool reuse = incremental.valid && movedDist <= incremental.radius &&
+                 directionShift(config, incremental.orientation, orientation, shift);
+
+    std::vector<double>& freeDist = incremental.freeDist;
+
+    if (reuse) {
+        // 2a. Rotation d'un quart de tour : simple décalage des certificats
+        if (shift != 0) {
+            std::rotate(freeDist.begin(), freeDist.begin() + shift, freeDist.end());
+        }
+
+        // Chaque nouveau rayon est dans le tube de l'ancien : ses cases sont libres jusqu'à
+        // freeDist[i]. Le DDA reprend de là et allonge ou raccourcit le rayon localement
+        // (version hiérarchique : un rayon qui longe un mur traverse vite les zones vides).
+        forEachRayChunk([&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                double t = certifyFreeDistance(startX, startY, dirX[i], dirY[i], 0.0, freeDist[i]);
+                ranges[i] = castDDA(startX, startY, dirX[i], dirY[i], config.maxRange, t);
+            }
+        });
+
+        // Le tube garanti autour des nouveaux rayons est plus étroit du déplacement effectué
+        incremental.radius -= movedDist;
+        incrementalStats.incrementalScans++;
+        for (int i = 0; i < n; i++) {
+            if (freeDist[i] > 0.0) incrementalStats.raysReused++;
+            else incrementalStats.raysRecast++;
+        }
+    } else {
+        // 2b. Échec des vérifications (premier scan, grand déplacement, rotation quelconque) :
+        // lancer complet, avec un nouveau tube de largeur INCREMENTAL_TUBE autour de chaque rayon
+        freeDist.resize(n);
+        forEachRayChunk([&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                freeDist[i] = certifyFreeDistance(startX, startY, dirX[i], dirY[i], INCREMENTAL_TUBE);
+                double t = certifyFreeDistance(startX, startY, dirX[i], dirY[i], 0.0, freeDist[i]);
+                ranges[i] = castDDA(startX, startY, dirX[i], dirY[i], config.maxRange, t);
+            }
+        });
+
+        incremental.radius = INCREMENTAL_TUBE;
+        incrementalStats.fullScans++;
+        incrementalStats.raysRecast += n;
+    }
+
+    incremental.valid = true;
+    incremental.origin = pos;
+    incremental.orientation = orientation;
+}
+
+// =========================================================
+// RÉPARTITION DES RAYONS
+// =========================================================
+void Lidar::forEachRayChunk(const std::function<void(int, int)>& body) const {
+    // Peu de rayons ou pas de groupe de threads : un seul appel, en série
+    if (pool == nullptr || config.numRays < PARALLEL_MIN_RAYS) {
+        body(0, config.numRays);
+        return;
+    }
+    pool->parallelFor(config.numRays, RAY_CHUNK, body);
+}
+
+// =========================================================
+// LANCER DE TOUS LES RAYONS
+// =========================================================
+void Lidar::castAll(const std::vector<double>& dirX, const std::vector<double>& dirY,
+                    std::vector<double>& ranges) const {
+    ranges.resize(config.numRays);
+
+    if (!scanCache.isEnabled()) {
+        castAllRays(dirX, dirY, ranges);
+        return;
+    }
+
+    // Seules les orientations multiples d'un quart de tour (les 4 du robot) sont mises en cache
+    cv::Point pos = robot->getPosition();
+    FanRotation rot = decomposeRotation(robot->getOrientation());
+    if (!rot.exact) {
+        castAllRays(dirX, dirY, ranges);
+        scanCache.quantize(ranges.data());
+        return;
+    }
+
+    // Pose déjà vue (éventuellement dans une autre orientation) : aucun rayon lancé
+    if (scanCache.lookup(pos, rot.quarter, ranges.data())) {
+        return;
+    }
+    castAllRays(dirX, dirY, ranges);
+    scanCache.insert(pos, rot.quarter, ranges.data());
+}
+
+void Lidar::castAllRays(const std::vector<double>& dirX, const std::vector<double>& dirY,
+                        std::vector<double>& ranges) const {
+    const int n = config.numRays;
+    ranges.resize(n);
+
+    cv::Point robotPos = robot->getPosition();
+    double startX = static_cast<double>(robotPos.x);
+    double startY = static_cast<double>(robotPos.y);
+
+    // Mode incrémental : réutilise les certificats du scan précédent
+    if (mode == RaycastMode::INCREMENTAL) {
+        castIncremental(dirX, dirY, ranges);
+        return;
+    }
+
+    // Modes scalaires : un lancer par rayon
+    // (chaque bloc écrit dans sa propre portion de 'ranges', aucun verrou nécessaire)
+    if (mode != RaycastMode::SIMD_BATCH) {
+        forEachRayChunk([&](int begin, int end) {
+            for (int i = begin; i < end; i++) {
+                ranges[i] = castRay(startX, startY, dirX[i], dirY[i]);
+            }
+        });
+        return;
+    }
+
+    // Mode SIMD : mêmes directions, en float
+    std::vector<float> dirXf(n), dirYf(n), out(n);
+    for (int i = 0; i < n; i++) {
+        dirXf[i] = static_cast<float>(dirX[i]);
+        dirYf[i] = static_cast<float>(dirY[i]);
+    }
+
+    ObstacleBitmap bitmap;
+    bitmap.bits = map->getObstacleBits();
+    bitmap.stride = map->getBitsStride();
+    bitmap.guard = Map::GUARD;
+    bitmap.width = map->getWidth();
+    bitmap.height = map->getHeight();
+
+    // Chaque bloc de rayons est un lot SIMD indépendant
+    forEachRayChunk([&](int begin, int end) {
+        RayBatch batch;
+        batch.originX = static_cast<float>(robotPos.x);
+        batch.originY = static_cast<float>(robotPos.y);
+        batch.dirX = dirXf.data() + begin;
+        batch.dirY = dirYf.data() + begin;
+        batch.count = end - begin;
+        batch.maxDist = static_cast<float>(config.maxRange);
+
+        castRayBatch(simdLevel, bitmap, batch, out.data() + begin);
+
+        for (int i = begin; i < end; i++) {
+            // Rayon passant par un coin de case : c'est le DDA en double qui tranche
+            ranges[i] = (out[i] == AMBIGUOUS_RANGE)
+                      ? castDDA(startX, startY, dirX[i], dirY[i], config.maxRange)
+                      : out[i];
+        }
+    });
 }
 
 // =========================================================
@@ -120,12 +675,11 @@ double Lidar::read(int rayID) const {
 // =========================================================
 std::vector<double> Lidar::readAll() const {
     std::vector<double> readings;
-    readings.reserve(num_rays); // Optimisation mémoire
-    
-    // Boucle pour scanner les 360 degrés
-    for (int i = 0; i < num_rays; i++) {
-        readings.push_back(read(i));
-    }
+    std::vector<double> dirX, dirY;
+
+    // Balayage complet avec l'algorithme actif
+    computeDirections(robot->getOrientation(), dirX, dirY);
+    castAll(dirX, dirY, readings);
     return readings;
 }
 
@@ -133,52 +687,186 @@ std::vector<double> Lidar::readAll() const {
 // CALCUL DES POINTS D'IMPACT (Pour OccupancyGrid)
 // =========================================================
 std::vector<cv::Point> Lidar::getHitPoints(const Robot& robot) const {
-    std::vector<cv::Point> hits;
+    const int n = config.numRays;
+    std::vector<cv::Point> hits(n);
     cv::Point pos = robot.getPosition();
-    double orientation = robot.getOrientation();
-
-    // On parcourt tous les rayons
-    for (int i = 0; i < num_rays; i++) {
-        double dist = read(i); // Obtient la distance du rayon i
-        
-        // Calcul de l'angle absolu de ce rayon
-        double angle = orientation + (i - num_rays / 2) * (M_PI / 180.0);
-        
-        // Trigonométrie pour retrouver les coordonnées (X, Y) du point d'impact
-        // x = x0 + dist * cos(theta)
-        // y = y0 + dist * sin(theta)
-        cv::Point p;
-        p.x = pos.x + static_cast<int>(dist * std::cos(angle));
-        p.y = pos.y + static_cast<int>(dist * std::sin(angle));
-        
-        hits.push_back(p);
-    }
-    
+
+    // Distances de tous les rayons (en parallèle si le groupe de threads est disponible)
+    std::vector<double> ranges;
+    std::vector<double> dirX, dirY;
+    computeDirections(this->robot->getOrientation(), dirX, dirY);
+    castAll(dirX, dirY, ranges);
+
+    // Points d'impact dans l'orientation du robot demandé
+    computeDirections(robot.getOrientation(), dirX, dirY);
+    LIDAR_DISPATCH_FAN(n, endpoints(pos, ranges.data(), dirX.data(), dirY.data(), n, hits.data()))
+
     return hits;
 }
 
+// =========================================================
+// SCAN COMPLET (Partagé par tous les consommateurs)
+// =========================================================
+void Lidar::scan(LidarScan& result) const {
+    // Un seul lancer par rayon et par tick
+    std::vector<double> dirX, dirY;
+    beginScan(result, dirX, dirY);
+    castAll(dirX, dirY, result.ranges);
+    finishScan(result, dirX, dirY);
+}
+
+void Lidar::beginScan(LidarScan& result, std::vector<double>& dirX, std::vector<double>& dirY) const {
+    const int n = config.numRays;
+
+    // resize() ne réalloue pas si la taille est déjà la bonne (cas de tous les ticks sauf le premier)
+    result.origin = robot->getPosition();
+    result.orientation = robot->getOrientation();
+    result.ranges.resize(n);
+    result.angles.resize(n);
+    result.hitPoints.resize(n);
+    result.hits.resize(n);
+
+    // Géométrie du balayage, pour adresser les rayons par angle
+    result.angleMin = rayAngle[0];
+    result.angleStep = rayStep;
+    result.fullCircle = config.isFullCircle();
+
+    computeDirections(robot->getOrientation(), dirX, dirY);
+}
+
+void Lidar::finishScan(LidarScan& result, const std::vector<double>& dirX, const std::vector<double>& dirY) const {
+    const int n = config.numRays;
+    double orientation = robot->getOrientation();
+
+    // Angles, drapeaux de contact et points d'impact : aucun cos/sin, tout vient des tables
+    LIDAR_DISPATCH_FAN(n, anglesAndHits(orientation, rayAngle.data(), result.ranges.data(), config.maxRange,
+                                        n, result.angles.data(), result.hits.data()))
+    LIDAR_DISPATCH_FAN(n, endpoints(result.origin, result.ranges.data(), dirX.data(), dirY.data(), n,
+                                    result.hitPoints.data()))
+}
+
+// =========================================================
+// SCAN FUSIONNÉ AVEC LA GRILLE D'OCCUPATION
+// =========================================================
+void Lidar::scanAndMap(LidarScan& result, OccupancyGrid& grid) const {
+    const int n = config.numRays;
+    std::vector<double> dirX, dirY;
+    beginScan(result, dirX, dirY);
+
+    double startX = static_cast<double>(result.origin.x);
+    double startY = static_cast<double>(result.origin.y);
+
+    // Pose déjà appliquée à cette grille (même contenu) : les distances viennent du cache, la
+    // grille est à jour. Une autre grille, ou la même après une modification directe, est marquée.
+    // (En mode LOG_ODDS, chaque scan ajoute de l'évidence : il faut le réappliquer.)
+    FanRotation rot = decomposeRotation(robot->getOrientation());
+    bool cacheable = scanCache.isEnabled() && rot.exact;
+    uint64_t mappedGrid = 0;
+    if (cacheable && scanCache.lookup(result.origin, rot.quarter, result.ranges.data(), &mappedGrid) &&
+        mappedGrid == grid.getContentId() && grid.getMode() == OccupancyMode::BINARY) {
+        finishScan(result, dirX, dirY);
+        return;
+    }
+
+    // Un seul parcours par rayon : le DDA marque les cases au fur et à mesure
+    // (toutes dans le carré de la portée autour du robot, à une case près)
+    const int reach = static_cast<int>(std::ceil(config.maxRange)) + 2;
+    grid.beginScanUpdate(cv::Rect(result.origin.x - reach, result.origin.y - reach, 2 * reach + 1, 2 * reach + 1));
+    GridCellVisitor visitor{grid};
+    for (int i = 0; i < n; i++) {
+        result.ranges[i] = traverseDDA(startX, startY, dirX[i], dirY[i], config.maxRange, 0.0, visitor);
+    }
+    grid.endScanUpdate();
+
+    // Mêmes distances quantifiées que scan() quand le cache est actif
+    if (cacheable) {
+        scanCache.insert(result.origin, rot.quarter, result.ranges.data(), grid.getContentId());
+    } else if (scanCache.isEnabled()) {
+        scanCache.quantize(result.ranges.data());
+    }
+
+    finishScan(result, dirX, dirY);
+}
+
+// =========================================================
+// POCHOIR DES RAYONS (Pour OccupancyGrid)
+// =========================================================
+void Lidar::buildRayStencil(RayStencil& stencil) const {
+    const int n = config.numRays;
+    std::vector<double> dirX, dirY;
+    computeDirections(0.0, dirX, dirY);
+    stencil.reset(n, config.maxRange, config.isFullCircle() && n % 4 == 0);
+
+    std::vector<cv::Point> cells;
+    std::vector<double> entryDist;
+    for (int i = 0; i < n; i++) {
+        // Même DDA que traverseDDA(), sans obstacle, depuis le coin (0, 0) : le robot est sur
+        // une position entière, la suite des cases est donc la même quelle que soit sa position
+        DDARay ray = initDDARay(0.0, 0.0, dirX[i], dirY[i]);
+        int nX = 0, nY = 0;
+        cv::Point cell(0, 0);
+
+        cells.assign(1, cell);
+        entryDist.assign(1, 0.0);
+        for (;;) {
+            double nextX = sideDistAt(ray.sideDistX, ray.deltaDistX, nX);
+            double nextY = sideDistAt(ray.sideDistY, ray.deltaDistY, nY);
+            double distance;
+            if (nextX < nextY) {
+                nX++;
+                cell.x += ray.stepX;
+                distance = nextX;
+            } else {
+                nY++;
+                cell.y += ray.stepY;
+                distance = nextY;
+            }
+            // Seules les cases où le DDA entre avant la portée sont marquées par un scan
+            if (distance >= config.maxRange) {
+                break;
+            }
+            cells.push_back(cell);
+            entryDist.push_back(distance);
+        }
+        stencil.addRay(cells, entryDist);
+    }
+}
+
+// =========================================================
+// ADRESSAGE DES RAYONS PAR ANGLE
+// =========================================================
+int LidarScan::rayIndexAt(double relativeAngle) const {
+    const long n = static_cast<long>(ranges.size());
+    if (n <= 1 || angleStep <= 0.0) {
+        return 0;
+    }
+
+    long index = std::lround((relativeAngle - angleMin) / angleStep);
+    if (fullCircle) {
+        // Tour complet : les indices bouclent (l'angle peut être donné à 2*PI près)
+        return static_cast<int>(((index % n) + n) % n);
+    }
+    // Secteur : rayon du bord le plus proche si l'angle est hors du champ de vision
+    return static_cast<int>(std::max(0L, std::min(n - 1, index)));
+}
+
+double LidarScan::rangeAt(double relativeAngle) const {
+    if (ranges.empty()) {
+        return 0.0;
+    }
+    return ranges[rayIndexAt(relativeAngle)];
+}
+
 // =========================================================
 // AFFICHAGE 
 // =========================================================
-void Lidar::draw(cv::Mat& image, const Robot& robot) const {
-    cv::Point pos = robot.getPosition();
-    double robotOrientation = robot.getOrientation();
-    
-    // Pour chaque rayon
-    for (int i = 0; i < num_rays; i++) {
-        double dist = read(i);
-        
+void Lidar::draw(cv::Mat& image, const LidarScan& scan) const {
+    // Pour chaque rayon du scan (déjà calculé : aucun nouveau lancer de rayon ici)
+    for (size_t i = 0; i < scan.ranges.size(); i++) {
         // Si le rayon touche quelque chose avant sa portée maximale
-        if (dist < max_range) {
-            double angle = robotOrientation + (i - num_rays / 2) * (M_PI / 180.0);
-            
-            // Calcul du point de fin pour le dessin
-            cv::Point endPoint;
-            endPoint.x = pos.x + static_cast<int>(dist * std::cos(angle));
-            endPoint.y = pos.y + static_cast<int>(dist * std::sin(angle));
-
+        if (scan.hits[i]) {
             // Dessine une ligne rouge (BGR: 0, 0, 255) représentant le laser
-            cv::line(image, pos, endPoint, cv::Scalar(0, 0, 255), 1); 
+            cv::line(image, scan.origin, scan.hitPoints[i], cv::Scalar(0, 0, 255), 1); 
         }
     }
 }
@@ -187,12 +875,91 @@ void Lidar::draw(cv::Mat& image, const Robot& robot) const {
 // GETTERS
 // =========================================================
 
+// Retourne le modèle du capteur
+const LidarConfig& Lidar::getConfig() const {
+    return config;
+}
+
 // Retourne le nombre de rayons du capteur
 int Lidar::getRayCount() const { 
-    return num_rays; 
+    return config.numRays; 
 }
 
 // Retourne la portée maximale définie
 double Lidar::getMaxRange() const { 
-    return max_range; 
+    return config.maxRange; 
+}
+
+// Retourne l'algorithme de lancer de rayons actif
+RaycastMode Lidar::getRaycastMode() const {
+    return mode;
+}
+
+// Retourne le jeu d'instructions du mode SIMD_BATCH
+SimdLevel Lidar::getSimdLevel() const {
+    return simdLevel;
+}
+
+// Retourne les compteurs du mode incrémental
+IncrementalStats Lidar::getIncrementalStats() const {
+    return incrementalStats;
+}
+
+// Retourne les compteurs du cache des scans
+ScanCacheStats Lidar::getScanCacheStats() const {
+    return scanCache.getStats();
+}
+
+// =========================================================
+// CONFIGURATION
+// =========================================================
+
+// Change le modèle du capteur (nombre de rayons, champ de vision, décalage, portée)
+bool Lidar::setConfig(const LidarConfig& newConfig) {
+    if (newConfig.numRays < 1 || !(newConfig.maxRange > 0.0) ||
+        !(newConfig.fov > 0.0) || newConfig.fov > 2.0 * M_PI + 1e-9) {
+        std::cerr << "ERREUR : configuration du Lidar invalide (" << newConfig.numRays << " rayons, fov "
+                  << newConfig.fov << " rad, portee " << newConfig.maxRange << " px)" << std::endl;
+        return false;
+    }
+    config = newConfig;
+    buildTables(); // Tables d'angles construites une seule fois par configuration
+    incremental.valid = false;
+
+    // Les scans en cache ne correspondent plus au capteur ; les 4 orientations ne sont des
+    // décalages exacts que pour un tour complet multiple de 4 rayons (voir buildTables())
+    scanCache.configure(config.numRays, config.maxRange, config.isFullCircle() && config.numRays % 4 == 0);
+    return true;
+}
+
+// Choisit l'algorithme utilisé par read() et toutes les méthodes qui en dépendent
+void Lidar::setRaycastMode(RaycastMode newMode) {
+    mode = newMode;
+    incremental.valid = false; // Le prochain scan incrémental repart d'un lancer complet
+}
+
+// Remet à zéro les compteurs du mode incrémental
+void Lidar::resetIncrementalStats() {
+    incrementalStats = IncrementalStats();
+}
+
+// Active (ou désactive avec 0) le cache des scans
+void Lidar::setScanCacheLimit(size_t maxBytes) {
+    scanCache.setMemoryLimit(maxBytes);
+}
+
+// Vide le cache des scans et remet ses compteurs à zéro
+void Lidar::clearScanCache() {
+    scanCache.clear();
+    scanCache.resetStats();
+}
+
+// Force le jeu d'instructions du mode SIMD_BATCH
+void Lidar::setSimdLevel(SimdLevel level) {
+    simdLevel = level;
+}
+
+// Partage un groupe de threads persistant (nullptr = en série)
+void Lidar::setThreadPool(ThreadPool* newPool) {
+    pool = newPool;
 }
\ No newline at end of file
@@ -0,0 +1,366 @@
+#include "../include/LidarSimd.hpp"
+#include <cmath>
+#include <algorithm>
+
+// Les noyaux SSE4 / AVX2 ne sont compilés que pour x86 avec GCC ou Clang :
+// l'attribut target() permet de les compiler sans activer AVX2 pour tout le programme,
+// le choix se faisant à l'exécution selon le processeur.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define LIDAR_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define LIDAR_SIMD_X86 0
+#endif
+
+// =========================================================
+// OUTILS
+// =========================================================
+
+// Lit le bit d'obstacle de la case (x, y) dans le bitmap de la Map (sans test de limites)
+static inline int obstacleBit(const ObstacleBitmap& map, int x, int y) {
+    unsigned col = static_cast<unsigned>(x + map.guard);
+    size_t row = static_cast<size_t>(y + map.guard);
+    return static_cast<int>((map.bits[row * map.stride + (col >> 6)] >> (col & 63)) & 1u);
+}
+
+// Écart relatif en dessous duquel deux côtés X / Y sont considérés à égalité.
+// Les distances sont calculées en float (erreur relative ~1e-7 par opération) : en dessous
+// de cet écart, l'ordre des pas pourrait différer de celui du DDA en double, et le rayon
+// pourrait passer de l'autre côté d'un coin de mur.
+static const float TIE_TOLERANCE = 1e-5f;
+
+// =========================================================
+// DÉTECTION DU JEU D'INSTRUCTIONS
+// =========================================================
+SimdLevel detectSimdLevel() {
+#if LIDAR_SIMD_X86
+    // Détection faite une seule fois (variable statique locale)
+    static const SimdLevel detected = []() {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return SimdLevel::AVX2;
+        if (__builtin_cpu_supports("sse4.1")) return SimdLevel::SSE4;
+        return SimdLevel::SCALAR;
+    }();
+    return detected;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2: return "AVX2";
+        case SimdLevel::SSE4: return "SSE4";
+        default:              return "SCALAR";
+    }
+}
+
+// =========================================================
+// NOYAU SCALAIRE (Portable, même algorithme en float)
+// =========================================================
+static void castRaysScalar(const ObstacleBitmap& map, const RayBatch& batch, float* outRanges) {
+    const int mapX0 = static_cast<int>(std::floor(batch.originX));
+    const int mapY0 = static_cast<int>(std::floor(batch.originY));
+    const float fracX = batch.originX - mapX0;
+    const float fracY = batch.originY - mapY0;
+
+    for (int i = 0; i < batch.count; i++) {
+        float dirX = batch.dirX[i];
+        float dirY = batch.dirY[i];
+
+        // Mêmes initialisations que le DDA de référence
+        float deltaX = (dirX == 0.0f) ? 1e30f : std::fabs(1.0f / dirX);
+        float deltaY = (dirY == 0.0f) ? 1e30f : std::fabs(1.0f / dirY);
+        int stepX = (dirX < 0.0f) ? -1 : 1;
+        int stepY = (dirY < 0.0f) ? -1 : 1;
+        float sideX = ((dirX < 0.0f) ? fracX : 1.0f - fracX) * deltaX;
+        float sideY = ((dirY < 0.0f) ? fracY : 1.0f - fracY) * deltaY;
+
+        int mapX = mapX0, mapY = mapY0;
+        float nX = 0.0f, nY = 0.0f; // Nombre de pas faits sur chaque axe
+        float result = batch.maxDist;
+
+        for (;;) {
+            // Distances des prochains côtés, calculées directement comme dans le DDA de référence
+            float nextX = sideX + nX * deltaX;
+            float nextY = sideY + nY * deltaY;
+            float dist;
+            if (nextX < nextY) {
+                dist = nextX;
+                nX += 1.0f;
+                mapX += stepX;
+            } else {
+                dist = nextY;
+                nY += 1.0f;
+                mapY += stepY;
+            }
+
+            // Quasi-égalité : l'ordre des pas dépend de l'arrondi, on laisse trancher le DDA en double
+            if (dist > 0.0f && std::fabs(nextX - nextY) <= dist * TIE_TOLERANCE) {
+                result = AMBIGUOUS_RANGE;
+                break;
+            }
+            if (obstacleBit(map, mapX, mapY)) {
+                // Sortie de carte considérée comme la portée max
+                bool inside = mapX >= 0 && mapX < map.width && mapY >= 0 && mapY < map.height;
+                result = inside ? dist : batch.maxDist;
+                break;
+            }
+            if (dist >= batch.maxDist) {
+                break;
+            }
+        }
+        outRanges[i] = result;
+    }
+}
+
+#if LIDAR_SIMD_X86
+
+// =========================================================
+// NOYAU SSE4.1 (4 rayons à la fois)
+// =========================================================
+__attribute__((target("sse4.1")))
+static void castRaysSSE4(const ObstacleBitmap& map, const RayBatch& batch, float* outRanges) {
+    const int mapX0 = static_cast<int>(std::floor(batch.originX));
+    const int mapY0 = static_cast<int>(std::floor(batch.originY));
+    const float fracX = batch.originX - mapX0;
+    const float fracY = batch.originY - mapY0;
+
+    const __m128 vZero = _mm_setzero_ps();
+    const __m128 vOne = _mm_set1_ps(1.0f);
+    const __m128 vInf = _mm_set1_ps(1e30f);
+    const __m128 vAbsMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 vMax = _mm_set1_ps(batch.maxDist);
+    const __m128 vTie = _mm_set1_ps(TIE_TOLERANCE);
+    const __m128 vAmbiguous = _mm_set1_ps(AMBIGUOUS_RANGE);
+    const __m128 vFracX = _mm_set1_ps(fracX), vInvFracX = _mm_set1_ps(1.0f - fracX);
+    const __m128 vFracY = _mm_set1_ps(fracY), vInvFracY = _mm_set1_ps(1.0f - fracY);
+    const __m128i vOneI = _mm_set1_epi32(1);
+    const __m128i vMinusOneI = _mm_set1_epi32(-1);
+    const __m128i vWidth = _mm_set1_epi32(map.width);
+    const __m128i vHeight = _mm_set1_epi32(map.height);
+    const __m128i vMinX = _mm_set1_epi32(-map.guard), vMaxX = _mm_set1_epi32(map.width + map.guard - 1);
+    const __m128i vMinY = _mm_set1_epi32(-map.guard), vMaxY = _mm_set1_epi32(map.height + map.guard - 1);
+
+    for (int base = 0; base < batch.count; base += 4) {
+        // Chargement des directions (le dernier lot est complété en répétant le dernier rayon)
+        alignas(16) float dx[4], dy[4];
+        for (int k = 0; k < 4; k++) {
+            int i = std::min(base + k, batch.count - 1);
+            dx[k] = batch.dirX[i];
+            dy[k] = batch.dirY[i];
+        }
+        __m128 dirX = _mm_load_ps(dx);
+        __m128 dirY = _mm_load_ps(dy);
+
+        // Initialisation du DDA sur les 4 voies
+        __m128 negX = _mm_cmplt_ps(dirX, vZero);
+        __m128 negY = _mm_cmplt_ps(dirY, vZero);
+        __m128 deltaX = _mm_blendv_ps(_mm_div_ps(vOne, _mm_and_ps(dirX, vAbsMask)), vInf, _mm_cmpeq_ps(dirX, vZero));
+        __m128 deltaY = _mm_blendv_ps(_mm_div_ps(vOne, _mm_and_ps(dirY, vAbsMask)), vInf, _mm_cmpeq_ps(dirY, vZero));
+        __m128 sideX = _mm_mul_ps(_mm_blendv_ps(vInvFracX, vFracX, negX), deltaX);
+        __m128 sideY = _mm_mul_ps(_mm_blendv_ps(vInvFracY, vFracY, negY), deltaY);
+        __m128i stepX = _mm_blendv_epi8(vOneI, vMinusOneI, _mm_castps_si128(negX));
+        __m128i stepY = _mm_blendv_epi8(vOneI, vMinusOneI, _mm_castps_si128(negY));
+
+        __m128i mapX = _mm_set1_epi32(mapX0);
+        __m128i mapY = _mm_set1_epi32(mapY0);
+        __m128 nX = _mm_setzero_ps(); // Nombre de pas faits sur chaque axe (en float)
+        __m128 nY = _mm_setzero_ps();
+        __m128 result = vMax;
+        __m128 active = _mm_castsi128_ps(vMinusOneI); // Toutes les voies actives
+
+        while (_mm_movemask_ps(active) != 0) {
+            // Chaque voie avance en X ou en Y selon sa propre direction
+            __m128 nextX = _mm_add_ps(sideX, _mm_mul_ps(nX, deltaX));
+            __m128 nextY = _mm_add_ps(sideY, _mm_mul_ps(nY, deltaY));
+            __m128 takeX = _mm_cmplt_ps(nextX, nextY);
+            __m128 dist = _mm_blendv_ps(nextY, nextX, takeX);
+            nX = _mm_add_ps(nX, _mm_and_ps(vOne, takeX));
+            nY = _mm_add_ps(nY, _mm_andnot_ps(takeX, vOne));
+            mapX = _mm_add_epi32(mapX, _mm_and_si128(stepX, _mm_castps_si128(takeX)));
+            mapY = _mm_add_epi32(mapY, _mm_andnot_si128(_mm_castps_si128(takeX), stepY));
+
+            // Les voies terminées continuent d'avancer (pas de dépendance entre la lecture
+            // du bitmap et le pas suivant) mais restent bornées à la bordure de garde
+            mapX = _mm_min_epi32(_mm_max_epi32(mapX, vMinX), vMaxX);
+            mapY = _mm_min_epi32(_mm_max_epi32(mapY, vMinY), vMaxY);
+
+            // Pas d'instruction "gather" en SSE : lecture des 4 bits en scalaire
+            alignas(16) int cx[4], cy[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(cx), mapX);
+            _mm_store_si128(reinterpret_cast<__m128i*>(cy), mapY);
+            __m128i bit = _mm_setr_epi32(obstacleBit(map, cx[0], cy[0]), obstacleBit(map, cx[1], cy[1]),
+                                         obstacleBit(map, cx[2], cy[2]), obstacleBit(map, cx[3], cy[3]));
+            __m128 hit = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(bit, vOneI)), active);
+
+            // Impact : distance mesurée, ou portée max si la case est hors carte
+            // (au plus un impact par voie : ce calcul est rarement exécuté)
+            if (_mm_movemask_ps(hit) != 0) {
+                __m128i inX = _mm_and_si128(_mm_cmpgt_epi32(mapX, vMinusOneI), _mm_cmpgt_epi32(vWidth, mapX));
+                __m128i inY = _mm_and_si128(_mm_cmpgt_epi32(mapY, vMinusOneI), _mm_cmpgt_epi32(vHeight, mapY));
+                __m128 hitValue = _mm_blendv_ps(vMax, dist, _mm_castsi128_ps(_mm_and_si128(inX, inY)));
+                result = _mm_blendv_ps(result, hitValue, hit);
+            }
+
+            // Quasi-égalité entre les deux côtés : la voie est marquée ambiguë
+            __m128 gap = _mm_and_ps(_mm_sub_ps(nextX, nextY), vAbsMask);
+            __m128 tie = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(gap, _mm_mul_ps(dist, vTie)), _mm_cmpgt_ps(dist, vZero)), active);
+            result = _mm_blendv_ps(result, vAmbiguous, tie);
+
+            // Une voie s'arrête sur un impact, une ambiguïté, ou quand elle atteint la portée max
+            __m128 reached = _mm_cmpge_ps(dist, vMax);
+            active = _mm_andnot_ps(_mm_or_ps(_mm_or_ps(hit, tie), reached), active);
+        }
+
+        alignas(16) float r[4];
+        _mm_store_ps(r, result);
+        for (int k = 0; k < 4 && base + k < batch.count; k++) {
+            outRanges[base + k] = r[k];
+        }
+    }
+}
+
+// =========================================================
+// NOYAU AVX2 (8 rayons à la fois)
+// =========================================================
+__attribute__((target("avx2")))
+static void castRaysAVX2(const ObstacleBitmap& map, const RayBatch& batch, float* outRanges) {
+    const int mapX0 = static_cast<int>(std::floor(batch.originX));
+    const int mapY0 = static_cast<int>(std::floor(batch.originY));
+    const float fracX = batch.originX - mapX0;
+    const float fracY = batch.originY - mapY0;
+
+    // Le bitmap est lu par mots de 32 bits (x86 est little-endian : le bit b d'un mot
+    // de 64 bits est le bit b % 32 du mot de 32 bits d'indice 2 * mot + b / 32)
+    const int* words32 = reinterpret_cast<const int*>(map.bits);
+
+    const __m256 vZero = _mm256_setzero_ps();
+    const __m256 vOne = _mm256_set1_ps(1.0f);
+    const __m256 vInf = _mm256_set1_ps(1e30f);
+    const __m256 vAbsMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 vMax = _mm256_set1_ps(batch.maxDist);
+    const __m256 vTie = _mm256_set1_ps(TIE_TOLERANCE);
+    const __m256 vAmbiguous = _mm256_set1_ps(AMBIGUOUS_RANGE);
+    const __m256 vFracX = _mm256_set1_ps(fracX), vInvFracX = _mm256_set1_ps(1.0f - fracX);
+    const __m256 vFracY = _mm256_set1_ps(fracY), vInvFracY = _mm256_set1_ps(1.0f - fracY);
+    const __m256i vOneI = _mm256_set1_epi32(1);
+    const __m256i vMinusOneI = _mm256_set1_epi32(-1);
+    const __m256i v31 = _mm256_set1_epi32(31);
+    const __m256i vGuard = _mm256_set1_epi32(map.guard);
+    const __m256i vStride32 = _mm256_set1_epi32(map.stride * 2);
+    const __m256i vWidth = _mm256_set1_epi32(map.width);
+    const __m256i vHeight = _mm256_set1_epi32(map.height);
+    const __m256i vMinX = _mm256_set1_epi32(-map.guard), vMaxX = _mm256_set1_epi32(map.width + map.guard - 1);
+    const __m256i vMinY = _mm256_set1_epi32(-map.guard), vMaxY = _mm256_set1_epi32(map.height + map.guard - 1);
+
+    for (int base = 0; base < batch.count; base += 8) {
+        // Chargement des directions (le dernier lot est complété en répétant le dernier rayon)
+        alignas(32) float dx[8], dy[8];
+        for (int k = 0; k < 8; k++) {
+            int i = std::min(base + k, batch.count - 1);
+            dx[k] = batch.dirX[i];
+            dy[k] = batch.dirY[i];
+        }
+        __m256 dirX = _mm256_load_ps(dx);
+        __m256 dirY = _mm256_load_ps(dy);
+
+        // Initialisation du DDA sur les 8 voies
+        __m256 negX = _mm256_cmp_ps(dirX, vZero, _CMP_LT_OQ);
+        __m256 negY = _mm256_cmp_ps(dirY, vZero, _CMP_LT_OQ);
+        __m256 deltaX = _mm256_blendv_ps(_mm256_div_ps(vOne, _mm256_and_ps(dirX, vAbsMask)), vInf,
+                                         _mm256_cmp_ps(dirX, vZero, _CMP_EQ_OQ));
+        __m256 deltaY = _mm256_blendv_ps(_mm256_div_ps(vOne, _mm256_and_ps(dirY, vAbsMask)), vInf,
+                                         _mm256_cmp_ps(dirY, vZero, _CMP_EQ_OQ));
+        __m256 sideX = _mm256_mul_ps(_mm256_blendv_ps(vInvFracX, vFracX, negX), deltaX);
+        __m256 sideY = _mm256_mul_ps(_mm256_blendv_ps(vInvFracY, vFracY, negY), deltaY);
+        __m256i stepX = _mm256_blendv_epi8(vOneI, vMinusOneI, _mm256_castps_si256(negX));
+        __m256i stepY = _mm256_blendv_epi8(vOneI, vMinusOneI, _mm256_castps_si256(negY));
+
+        __m256i mapX = _mm256_set1_epi32(mapX0);
+        __m256i mapY = _mm256_set1_epi32(mapY0);
+        __m256 nX = _mm256_setzero_ps(); // Nombre de pas faits sur chaque axe (en float)
+        __m256 nY = _mm256_setzero_ps();
+        __m256 result = vMax;
+        __m256 active = _mm256_castsi256_ps(vMinusOneI); // Toutes les voies actives
+
+        while (_mm256_movemask_ps(active) != 0) {
+            // Chaque voie avance en X ou en Y selon sa propre direction
+            __m256 nextX = _mm256_add_ps(sideX, _mm256_mul_ps(nX, deltaX));
+            __m256 nextY = _mm256_add_ps(sideY, _mm256_mul_ps(nY, deltaY));
+            __m256 takeX = _mm256_cmp_ps(nextX, nextY, _CMP_LT_OQ);
+            __m256 dist = _mm256_blendv_ps(nextY, nextX, takeX);
+            nX = _mm256_add_ps(nX, _mm256_and_ps(vOne, takeX));
+            nY = _mm256_add_ps(nY, _mm256_andnot_ps(takeX, vOne));
+            mapX = _mm256_add_epi32(mapX, _mm256_and_si256(stepX, _mm256_castps_si256(takeX)));
+            mapY = _mm256_add_epi32(mapY, _mm256_andnot_si256(_mm256_castps_si256(takeX), stepY));
+
+            // Les voies terminées continuent d'avancer (pas de dépendance entre la lecture
+            // du bitmap et le pas suivant) mais restent bornées à la bordure de garde
+            mapX = _mm256_min_epi32(_mm256_max_epi32(mapX, vMinX), vMaxX);
+            mapY = _mm256_min_epi32(_mm256_max_epi32(mapY, vMinY), vMaxY);
+
+            // Lecture des 8 bits d'obstacle en une instruction "gather"
+            __m256i col = _mm256_add_epi32(mapX, vGuard);
+            __m256i row = _mm256_add_epi32(mapY, vGuard);
+            __m256i index = _mm256_add_epi32(_mm256_mullo_epi32(row, vStride32), _mm256_srli_epi32(col, 5));
+            __m256i words = _mm256_i32gather_epi32(words32, index, 4);
+            __m256i bit = _mm256_and_si256(_mm256_srlv_epi32(words, _mm256_and_si256(col, v31)), vOneI);
+            __m256 hit = _mm256_and_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(bit, vOneI)), active);
+
+            // Impact : distance mesurée, ou portée max si la case est hors carte
+            // (au plus un impact par voie : ce calcul est rarement exécuté)
+            if (_mm256_movemask_ps(hit) != 0) {
+                __m256i inX = _mm256_and_si256(_mm256_cmpgt_epi32(mapX, vMinusOneI), _mm256_cmpgt_epi32(vWidth, mapX));
+                __m256i inY = _mm256_and_si256(_mm256_cmpgt_epi32(mapY, vMinusOneI), _mm256_cmpgt_epi32(vHeight, mapY));
+                __m256 hitValue = _mm256_blendv_ps(vMax, dist, _mm256_castsi256_ps(_mm256_and_si256(inX, inY)));
+                result = _mm256_blendv_ps(result, hitValue, hit);
+            }
+
+            // Quasi-égalité entre les deux côtés : la voie est marquée ambiguë
+            __m256 gap = _mm256_and_ps(_mm256_sub_ps(nextX, nextY), vAbsMask);
+            __m256 tie = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(gap, _mm256_mul_ps(dist, vTie), _CMP_LE_OQ),
+                                                     _mm256_cmp_ps(dist, vZero, _CMP_GT_OQ)), active);
+            result = _mm256_blendv_ps(result, vAmbiguous, tie);
+
+            // Une voie s'arrête sur un impact, une ambiguïté, ou quand elle atteint la portée max
+            __m256 reached = _mm256_cmp_ps(dist, vMax, _CMP_GE_OQ);
+            active = _mm256_andnot_ps(_mm256_or_ps(_mm256_or_ps(hit, tie), reached), active);
+        }
+
+        alignas(32) float r[8];
+        _mm256_store_ps(r, result);
+        for (int k = 0; k < 8 && base + k < batch.count; k++) {
+            outRanges[base + k] = r[k];
+        }
+    }
+}
+
+#endif // LIDAR_SIMD_X86
+
+// =========================================================
+// AIGUILLAGE (Choix du noyau à l'exécution)
+// =========================================================
+void castRayBatch(SimdLevel level, const ObstacleBitmap& map, const RayBatch& batch, float* outRanges) {
+    if (batch.count <= 0) {
+        return;
+    }
+
+    // On ne dépasse jamais ce que le processeur sait faire
+    SimdLevel supported = detectSimdLevel();
+    if (level > supported) {
+        level = supported;
+    }
+
+#if LIDAR_SIMD_X86
+    if (level == SimdLevel::AVX2) {
+        castRaysAVX2(map, batch, outRanges);
+        return;
+    }
+    if (level == SimdLevel::SSE4) {
+        castRaysSSE4(map, batch, outRanges);
+        return;
+    }
+#endif
+    castRaysScalar(map, batch, outRanges);
+}
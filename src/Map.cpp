@@ -1,11 +1,12 @@
 #include "../include/Map.hpp"
 #include <iostream>
 #include <cstdlib> // Pour exit()
+#include <cstdint>
 
 // =========================================================
 // CONSTRUCTEUR
 // =========================================================
-Map::Map(const std::string& filename) {
+Map::Map(const std::string& filename) : path(filename) {
     
     // Charge l'image depuis le fichier en mode couleur (BGR)
     // IMREAD_COLOR est important car on accède aux pixels via Vec3b (3 canaux)
@@ -19,47 +20,150 @@ Map::Map(const std::string& filename) {
         exit(1);
     }
 
+    initialize();
+}
+
+Map::Map(const cv::Mat& bgrImage) {
+    // On garde notre propre copie pour ne pas dépendre de l'appelant
+    image = bgrImage.clone();
+
+    if (image.empty() || image.type() != CV_8UC3) {
+        std::cerr << "ERREUR CRITIQUE : La carte fournie doit etre une image BGR non vide." << std::endl;
+        exit(1);
+    }
+
+    initialize();
+}
+
+// =========================================================
+// INITIALISATION COMMUNE
+// =========================================================
+void Map::initialize() {
     // Initialisation des dimensions internes pour un accès rapide
     // image.cols correspond à la largeur (axe X)
     width = image.cols;
     // image.rows correspond à la hauteur (axe Y)
     height = image.rows;
-    
+
+    // Construction du bitmap compact utilisé par toutes les requêtes d'obstacle
+    buildObstacleBits();
+
+    // Pré-calcul des distances aux murs (une seule fois au chargement)
+    buildDistanceField();
+
+    // Pyramide "contient un mur ?" pour sauter les zones vides pendant le raycasting
+    buildPyramid();
+
     std::cout << "Carte chargee avec succes: " << width << "x" << height << " pixels." << std::endl;
 }
 
 // =========================================================
-// MÉTHODE PRINCIPALE : DÉTECTION D'OBSTACLE
+// CONSTRUCTION DU BITMAP DES OBSTACLES
 // =========================================================
-bool Map::isObstacle(int x, int y) const {
-    // 1. Vérification des limites de la carte (Bounds Check)
-    // Si on demande un point en dehors de l'image, on considère que c'est un mur.
-    // Cela empêche le robot de sortir de l'écran.
-    if (x < 0 || x >= width || y < 0 || y >= height) {
-        return true; 
+void Map::buildObstacleBits() {
+    // Dimensions du bitmap avec la bordure de garde de chaque côté
+    int paddedWidth = width + 2 * GUARD;
+    int paddedHeight = height + 2 * GUARD;
+
+    // Nombre de mots de 64 bits nécessaires pour une ligne (arrondi au supérieur)
+    bitsStride = (paddedWidth + 63) / 64;
+
+    // On part d'un bitmap entièrement "mur" (tous les bits à 1) :
+    // la bordure de garde est ainsi déjà remplie d'obstacles.
+    obstacleBits.assign(static_cast<size_t>(bitsStride) * paddedHeight, ~0ULL);
+
+    // Puis on "creuse" les cases libres de la carte
+    for (int y = 0; y < height; y++) {
+        // Accès direct à la ligne de l'image (plus rapide que at<> pixel par pixel)
+        const cv::Vec3b* row = image.ptr<cv::Vec3b>(y);
+        uint64_t* bitsRow = &obstacleBits[static_cast<size_t>(y + GUARD) * bitsStride];
+
+        for (int x = 0; x < width; x++) {
+            // Un obstacle est un pixel parfaitement NOIR (0, 0, 0), comme avant
+            if (row[x] != cv::Vec3b(0, 0, 0)) {
+                unsigned col = static_cast<unsigned>(x + GUARD);
+                bitsRow[col >> 6] &= ~(1ULL << (col & 63)); // Case libre : bit à 0
+            }
+        }
     }
+}
 
-    // 2. Accès au pixel à la coordonnée (y, x)
-    // Attention : OpenCV utilise l'ordre (row, col), donc (y, x).
-    // Vec3b signifie "Vector of 3 bytes" (Blue, Green, Red).
-    cv::Vec3b pixel = image.at<cv::Vec3b>(y, x);
-    
-    // 3. Analyse de la couleur
-    // On considère qu'un obstacle est un pixel parfaitement NOIR (0, 0, 0).
-    // Note : OpenCV stocke les couleurs en BGR (Bleu, Vert, Rouge).
-    if (pixel == cv::Vec3b(0, 0, 0)) {
-        return true; // C'est un mur
+// =========================================================
+// CONSTRUCTION DU CHAMP DE DISTANCE
+// =========================================================
+void Map::buildDistanceField() {
+    // Masque des zones libres : 255 = libre, 0 = mur (distanceTransform mesure la
+    // distance de chaque pixel non nul jusqu'au pixel nul le plus proche)
+    cv::Mat freeMask(height, width, CV_8UC1);
+    for (int y = 0; y < height; y++) {
+        uchar* row = freeMask.ptr<uchar>(y);
+        for (int x = 0; x < width; x++) {
+            row[x] = isObstacle(x, y) ? 0 : 255;
+        }
     }
-    
-    // Si ce n'est pas noir, c'est libre (blanc, gris, etc.)
-    return false;
-} 
+
+    // On entoure le masque d'une bordure de murs d'un pixel :
+    // le bord de la carte compte comme un obstacle, comme dans isObstacle()
+    cv::Mat paddedMask;
+    cv::copyMakeBorder(freeMask, paddedMask, 1, 1, 1, 1, cv::BORDER_CONSTANT, cv::Scalar(0));
+
+    // Transformée de distance euclidienne exacte (DIST_MASK_PRECISE)
+    cv::Mat paddedDistance;
+    cv::distanceTransform(paddedMask, paddedDistance, cv::DIST_L2, cv::DIST_MASK_PRECISE);
+
+    // On retire la bordure pour revenir aux coordonnées de la carte
+    distanceField = paddedDistance(cv::Rect(1, 1, width, height)).clone();
+}
+
+// =========================================================
+// CONSTRUCTION DE LA PYRAMIDE D'OBSTACLES
+// =========================================================
+void Map::buildPyramid() {
+    pyramidBits.assign(PYRAMID_LEVELS, std::vector<uint64_t>());
+    pyramidStride.assign(PYRAMID_LEVELS, 0);
+
+    // Niveau précédent (on part du bitmap des cases, niveau 0)
+    const std::vector<uint64_t>* childBits = &obstacleBits;
+    int childStride = bitsStride;
+    int childWidth = width + 2 * GUARD;
+    int childHeight = height + 2 * GUARD;
+
+    for (int level = 1; level <= PYRAMID_LEVELS; level++) {
+        // Chaque bloc du niveau courant regroupe 2x2 blocs du niveau précédent
+        int levelWidth = (childWidth + 1) / 2;
+        int levelHeight = (childHeight + 1) / 2;
+        int stride = (levelWidth + 63) / 64;
+
+        std::vector<uint64_t>& bits = pyramidBits[level - 1];
+        bits.assign(static_cast<size_t>(stride) * levelHeight, 0);
+        pyramidStride[level - 1] = stride;
+
+        for (int y = 0; y < childHeight; y++) {
+            const uint64_t* childRow = &(*childBits)[static_cast<size_t>(y) * childStride];
+            uint64_t* row = &bits[static_cast<size_t>(y / 2) * stride];
+
+            for (int x = 0; x < childWidth; x++) {
+                // Un bloc contient un mur dès qu'un de ses 4 enfants en contient un ("max")
+                if ((childRow[x >> 6] >> (x & 63)) & 1u) {
+                    int parentX = x / 2;
+                    row[parentX >> 6] |= 1ULL << (parentX & 63);
+                }
+            }
+        }
+
+        childBits = &bits;
+        childStride = stride;
+        childWidth = levelWidth;
+        childHeight = levelHeight;
+    }
+}
 
 // =========================================================
 // GETTERS
 // =========================================================
 
 // Retourne une copie ou une référence à la matrice image
+// (Uniquement pour l'affichage : les obstacles sont lus dans le bitmap)
 cv::Mat Map::getImage() const {
     return image; 
 }
@@ -72,4 +176,18 @@ int Map::getWidth() const {
 // Retourne la hauteur stockée
 int Map::getHeight() const { 
     return height; 
-}
\ No newline at end of file
+}
+
+const std::string& Map::getPath() const {
+    return path;
+}
+
+// Retourne le début du bitmap des obstacles (bordure de garde comprise)
+const uint64_t* Map::getObstacleBits() const {
+    return obstacleBits.data();
+}
+
+// Retourne le nombre de mots de 64 bits par ligne du bitmap
+int Map::getBitsStride() const {
+    return bitsStride;
+}
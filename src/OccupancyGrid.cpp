@@ -1,11 +1,29 @@
 #include "../include/OccupancyGrid.hpp"
+#include "../include/Lidar.hpp"
+#include "../include/PackedTriStateGrid.hpp"
+#include "../include/OccupancySnapshot.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <iostream>
+
+// Définition du membre statique (nécessaire en C++11 quand il est pris par référence, ex: std::min)
+const int OccupancyGrid::TILE_SIZE;
+
+// Identifiants de contenu, uniques pour tout le programme (0 : aucune grille)
+static uint64_t nextContentId() {
+    static std::atomic<uint64_t> counter(0);
+    return ++counter;
+}
 
 // =========================================================
 // CONSTRUCTEUR
 // =========================================================
 OccupancyGrid::OccupancyGrid(int w, int h, int cellS) 
     // Initialisation des membres via la liste d'initialisation
-    : width(w), height(h), cellSize(cellS) 
+    : width(w), height(h), cellSize(cellS), allocatedTiles(0), contentId(nextContentId()),
+      snapshotSequence(0), copiedTiles(0), lastUpdateCells(0), explorationThreshold(0.311),
+      lastSmoothIterations(0), mode(OccupancyMode::BINARY), simdLevel(detectSimdLevel())
 {
     // Calcul de la largeur de la grille (ex: 500px / 10 = 50 cases)
     gridW = width / cellSize;
@@ -13,9 +31,27 @@ OccupancyGrid::OccupancyGrid(int w, int h, int cellS)
     // Calcul de la hauteur de la grille (ex: 200px / 10 = 20 cases)
     gridH = height / cellSize;
     
-    // Création de la matrice image (niveau de gris 8 bits - 1 canal)
-    // On remplit tout avec 127 (Gris) pour dire "Zone Inconnue" au départ
-    grid = cv::Mat(gridH, gridW, CV_8UC1, cv::Scalar(127));
+    // Découpage en tuiles (la dernière ligne / colonne peut être incomplète).
+    // Aucune tuile n'est allouée : toutes les cases sont à 127 (Gris) pour dire "Zone Inconnue"
+    // au départ, sans rien stocker. Aucune tuile n'est marquée : la première image est
+    // dessinée en entier par draw().
+    tilesX = (gridW + TILE_SIZE - 1) / TILE_SIZE;
+    tilesY = (gridH + TILE_SIZE - 1) / TILE_SIZE;
+    std::memset(blankTile.cells, 127, sizeof(blankTile.cells));
+    tiles.assign(tilesX * tilesY, &blankTile);
+    tileOwners.resize(tilesX * tilesY);
+    tileWritable.assign(tilesX * tilesY, 0);
+    unknownCount = gridW * gridH;
+    freeCount = 0;
+    renderDirty.assign(tilesX * tilesY, 0);
+    smoothDirty.assign(tilesX * tilesY, 0);
+
+    // Pyramide : toutes les cases inconnues, comme la grille
+    pyramid.reset(gridW, gridH);
+    pyramidDirty.assign(tilesX * tilesY, 0);
+
+    // Modèle probabiliste par défaut (utilisé seulement en mode LOG_ODDS)
+    setLogOddsConfig(LogOddsConfig());
 }
 
 // =========================================================
@@ -25,6 +61,14 @@ void OccupancyGrid::update(const std::vector<cv::Point>& scanPoints, cv::Point r
     // Conversion de la position réelle du robot en coordonnées "Grille"
     // (ex: Robot à 105,105 avec cellSize=10 devient Case 10,10)
     cv::Point gridRobot = robotPos / cellSize;
+    lastUpdateCells = 0;
+
+    // Toutes les cases du scan sont dans le rectangle englobant le robot et les impacts
+    cv::Rect area(robotPos, robotPos + cv::Point(1, 1));
+    for (const auto& point : scanPoints) {
+        area |= cv::Rect(point, point + cv::Point(1, 1));
+    }
+    beginScanUpdate(area);
 
     // On parcourt chaque point d'impact détecté par le Lidar
     for (const auto& point : scanPoints) {
@@ -37,22 +81,33 @@ void OccupancyGrid::update(const std::vector<cv::Point>& scanPoints, cv::Point r
             continue;
         }
 
-        // Création d'un itérateur de ligne (Algorithme de Bresenham optimisé par OpenCV)
-        // Cet outil va nous donner la liste de toutes les cases entre le robot et l'impact
-        cv::LineIterator it(grid, gridRobot, gridHit);
+        // Tracé de ligne (Algorithme de Bresenham, 8-connexe) : toutes les cases entre le robot
+        // et l'impact. (Plus de cv::LineIterator : il demande une matrice dense de la grille.)
+        const int dx = std::abs(gridHit.x - gridRobot.x);
+        const int dy = -std::abs(gridHit.y - gridRobot.y);
+        const int stepX = (gridRobot.x < gridHit.x) ? 1 : -1;
+        const int stepY = (gridRobot.y < gridHit.y) ? 1 : -1;
+        const int count = std::max(dx, -dy) + 1;
+        int err = dx + dy;
+        cv::Point cell = gridRobot;
 
         // On parcourt chaque case le long du rayon laser
-        for (int i = 0; i < it.count; i++, ++it) {
-            // Récupère les coordonnées de la case courante
-            cv::Point cell = it.pos();
-            
+        for (int i = 0; i < count; i++) {
+            if (i > 0) {
+                // Case suivante : pas en x, en y, ou les deux selon l'erreur accumulée
+                const int e2 = 2 * err;
+                if (e2 >= dy) { err += dy; cell.x += stepX; }
+                if (e2 <= dx) { err += dx; cell.y += stepY; }
+            }
+
             // Seconde vérification de sécurité (pour ne pas écrire hors mémoire)
             if (cell.x < 0 || cell.x >= gridW || cell.y < 0 || cell.y >= gridH) {
                 continue;
             }
 
             // Vérifie si on est arrivé à la dernière case du rayon (là où ça a tapé)
-            bool isEnd = (i == it.count - 1);
+            bool isEnd = (i == count - 1);
+            lastUpdateCells++;
 
             if (isEnd) {
                 // --- GESTION DE L'OBSTACLE (Fin du rayon) ---
@@ -64,7 +119,8 @@ void OccupancyGrid::update(const std::vector<cv::Point>& scanPoints, cv::Point r
                 // on considère que c'est un vrai mur et pas juste la limite du capteur.
                 if (dist < 98.0) {
                     // On marque la case comme OBSTACLE (0 = Noir)
-                    grid.at<uchar>(cell) = 0; 
+                    // (markOccupied prend un pixel du monde et tient les compteurs à jour)
+                    markOccupied(cell.x * cellSize, cell.y * cellSize);
                 }
             } else {
                 // --- GESTION DE L'ESPACE LIBRE (Le long du rayon) ---
@@ -73,105 +129,828 @@ void OccupancyGrid::update(const std::vector<cv::Point>& scanPoints, cv::Point r
                 // PROTECTION CRITIQUE : On ne remplace JAMAIS un obstacle (0) par du vide.
                 // Si la case est déjà noire (0), on ne fait rien.
                 // Sinon (Gris ou Blanc), on la marque comme LIBRE (255 = Blanc).
-                if (grid.at<uchar>(cell) != 0) {
-                    grid.at<uchar>(cell) = 255;
-                }
+                markFree(cell.x * cellSize, cell.y * cellSize);
+            }
+        }
+    }
+    endScanUpdate();
+}
+
+// Mise à jour à partir du scan partagé : aucun nouveau lancer de rayon
+void OccupancyGrid::update(const LidarScan& scan) {
+    int quarter = 0;
+    bool stencilUsable = stencil.isReady() &&
+                         static_cast<int>(scan.ranges.size()) == stencil.getRayCount() &&
+                         RayStencil::quarterOf(scan.orientation, quarter) &&
+                         (quarter == 0 || stencil.isRotatable());
+
+    if (stencilUsable) {
+        // Chaque case libre écrite une seule fois, chaque rayon arrêté à son impact.
+        // Les cases du DDA sont à une case près dans le rectangle du robot et des impacts.
+        cv::Rect area(scan.origin, scan.origin + cv::Point(1, 1));
+        for (const auto& point : scan.hitPoints) {
+            area |= cv::Rect(point, point + cv::Point(1, 1));
+        }
+        beginScanUpdate(cv::Rect(area.x - 2, area.y - 2, area.width + 4, area.height + 4));
+        lastUpdateCells = stencil.apply(*this, scan.origin, quarter, scan.ranges);
+        endScanUpdate();
+    } else {
+        // Orientation quelconque ou pas de pochoir : tracé des lignes jusqu'aux points d'impact
+        update(scan.hitPoints, scan.origin);
+    }
+}
+
+// Construit le pochoir des rayons à partir du modèle du capteur
+void OccupancyGrid::useRayStencil(const Lidar& lidar) {
+    lidar.buildRayStencil(stencil);
+}
+
+// =========================================================
+// MODE PROBABILISTE (Log-odds)
+// =========================================================
+void OccupancyGrid::setMode(OccupancyMode newMode) {
+    if (newMode == mode) {
+        return;
+    }
+    mode = newMode;
+    evidenceRect = cv::Rect();
+    contentId = nextContentId(); // Les scans appliqués dans l'autre mode ne comptent plus
+
+    for (int index = 0; index < tilesX * tilesY; index++) {
+        if (tiles[index] == &blankTile) {
+            continue; // Tuile absente : inconnue, log-odds nuls
+        }
+        Tile* tile = tileAt(index); // Copiée si un instantané la garde
+        if (mode == OccupancyMode::BINARY) {
+            // La vue seuillée devient la grille : les log-odds ne servent plus
+            std::vector<int16_t>().swap(tile->logOdds);
+            continue;
+        }
+
+        // Log-odds de départ selon l'état de chaque case (la vue seuillée ne change pas)
+        tile->logOdds.resize(TILE_CELLS);
+        for (int i = 0; i < TILE_CELLS; i++) {
+            if (tile->cells[i] == 0) {
+                tile->logOdds[i] = logOddsParams.occupiedThreshold;
+            } else if (tile->cells[i] == 255) {
+                tile->logOdds[i] = logOddsParams.freeThreshold;
+            } else {
+                tile->logOdds[i] = 0;
+            }
+        }
+    }
+}
+
+void OccupancyGrid::setLogOddsConfig(const LogOddsConfig& config) {
+    // Valeurs ramenées dans les int16, bornes ordonnées, seuils entre les bornes
+    auto toInt16 = [](int value) {
+        return static_cast<int16_t>(std::max(-32768, std::min(32767, value)));
+    };
+    logOddsConfig = config;
+    logOddsParams.hit = toInt16(config.hit);
+    logOddsParams.miss = toInt16(config.miss);
+    logOddsParams.minValue = toInt16(std::min(config.minValue, config.maxValue));
+    logOddsParams.maxValue = toInt16(std::max(config.minValue, config.maxValue));
+    logOddsParams.occupiedThreshold = std::max(logOddsParams.minValue, std::min(logOddsParams.maxValue, toInt16(config.occupiedThreshold)));
+    logOddsParams.freeThreshold = std::max(logOddsParams.minValue, std::min(logOddsParams.maxValue, toInt16(config.freeThreshold)));
+
+    if (mode != OccupancyMode::LOG_ODDS) {
+        return;
+    }
+
+    // Une tuile absente vaut "inconnu, log-odds nul" : si un log-odds nul n'est plus inconnu
+    // avec ces seuils, toutes les tuiles doivent exister pour porter leur nouvel état
+    if (logOddsParams.occupiedThreshold <= 0 || logOddsParams.freeThreshold >= 0) {
+        for (int tile = 0; tile < tilesX * tilesY; tile++) {
+            tileAt(tile);
+        }
+    }
+
+    // Nouveaux bornes et seuils : log-odds limités et vue seuillée recalculée
+    for (int index = 0; index < tilesX * tilesY; index++) {
+        if (tiles[index] == &blankTile) {
+            continue;
+        }
+        Tile* tile = tileAt(index);
+        for (int i = 0; i < TILE_CELLS; i++) {
+            int16_t& value = tile->logOdds[i];
+            value = std::max(logOddsParams.minValue, std::min(logOddsParams.maxValue, value));
+            if (value >= logOddsParams.occupiedThreshold) {
+                tile->cells[i] = 0;
+            } else if (value <= logOddsParams.freeThreshold) {
+                tile->cells[i] = 255;
+            } else {
+                tile->cells[i] = 127;
+            }
+        }
+    }
+    recount();
+}
+
+void OccupancyGrid::beginScanUpdate(const cv::Rect& area) {
+    if (mode != OccupancyMode::LOG_ODDS) {
+        return;
+    }
+
+    // Rectangle de pixels -> rectangle de cases (limité à la grille)
+    cv::Rect pixels = area & cv::Rect(0, 0, gridW * cellSize, gridH * cellSize);
+    if (pixels.area() == 0) {
+        evidenceRect = cv::Rect();
+        return;
+    }
+    int x0 = pixels.x / cellSize;
+    int y0 = pixels.y / cellSize;
+    int x1 = (pixels.x + pixels.width - 1) / cellSize;
+    int y1 = (pixels.y + pixels.height - 1) / cellSize;
+    evidenceRect = cv::Rect(x0, y0, x1 - x0 + 1, y1 - y0 + 1);
+    evidence.assign(static_cast<size_t>(evidenceRect.area()), EVIDENCE_NONE);
+}
+
+void OccupancyGrid::endScanUpdate() {
+    if (mode != OccupancyMode::LOG_ODDS || evidenceRect.area() == 0) {
+        evidenceRect = cv::Rect();
+        return;
+    }
+
+    // Fenêtre fermée avant d'appliquer (les marquages suivants seront immédiats)
+    const cv::Rect window = evidenceRect;
+    evidenceRect = cv::Rect();
+    for (int y = 0; y < window.height; y++) {
+        applyEvidence(window.y + y, window.x, window.width, &evidence[static_cast<size_t>(y) * window.width]);
+    }
+}
+
+void OccupancyGrid::applyEvidence(int gy, int x0, int count, const uchar* kinds) {
+    // Un appel au noyau par morceau de ligne contenu dans une tuile (cases contiguës) :
+    // chaque morceau qui change marque sa tuile
+    const int end = x0 + count;
+    for (int x = x0; x < end; ) {
+        const int segmentEnd = std::min(end, ((x >> TILE_SHIFT) + 1) << TILE_SHIFT);
+        const uchar* segmentKinds = kinds + (x - x0);
+        const int tile = tileIndex(x, gy);
+
+        // Tuile absente (ou gardée par un instantané) : allouée (ou copiée) seulement si le scan
+        // y a vu une case (la fenêtre d'évidences est un rectangle, le disque de portée n'en
+        // couvre qu'une partie)
+        Tile* t = tiles[tile];
+        if (!tileWritable[tile]) {
+            uchar seen = 0;
+            for (int i = 0; i < segmentEnd - x; i++) {
+                seen |= segmentKinds[i];
+            }
+            if (seen == 0) {
+                x = segmentEnd;
+                continue;
             }
+            t = tileAt(tile);
         }
+
+        const int offset = cellOffset(x, gy);
+        LogOddsRowChanges changes;
+        applyLogOddsRow(simdLevel, t->logOdds.data() + offset, t->cells + offset, segmentKinds,
+                        segmentEnd - x, logOddsParams, changes);
+        if (changes.changed != 0) {
+            unknownCount += changes.unknown;
+            freeCount += changes.free;
+            markTileDirty(tile, changes.obstacleChanges != 0);
+        }
+        x = segmentEnd;
     }
 }
 
 // =========================================================
 // NETTOYAGE DE LA CARTE (Post-Processing)
 // =========================================================
+
+// Indice du bit à 1 le plus bas d'un mot non nul
+static inline int lowestSetBit(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(word);
+#else
+    int bit = 0;
+    while (((word >> bit) & 1) == 0) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
 void OccupancyGrid::smoothGrid(int iterations) {
-    // 1. Création d'un masque binaire où les obstacles sont blancs (255) et le reste noir (0)
-    // L'opérateur (grid == 0) crée cette image binaire automatiquement
-    cv::Mat obstacleMask = (grid == 0);
-    
-    // 2. Définition de l'élément structurant (un carré de 3x3 pixels)
-    // C'est la forme qu'on va utiliser pour "boucher les trous"
-    cv::Mat kernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
-    
-    // 3. Application de la "Fermeture" (Closing) morphologique
-    // Fermeture = Dilatation suivie d'une Érosion.
-    // Cela permet de relier les points noirs proches et de combler les petits interstices.
-    cv::morphologyEx(obstacleMask, obstacleMask, cv::MORPH_CLOSE, kernel, cv::Point(-1, -1), iterations);
-    
-    // 4. Réapplication du masque nettoyé sur la grille principale
+    // Après un lissage, la grille est déjà "fermée" : seule l'apparition de nouveaux obstacles
+    // peut changer le résultat, et seulement à moins de 2 * iterations cases de ceux-ci
+    // (dilatation puis érosion, d'une case chacune par itération avec un noyau 3x3).
+    const int halo = 2 * iterations;
+    const cv::Rect gridRect(0, 0, gridW, gridH);
+
+    // Une grille fermée pour un nombre d'itérations ne l'est pas pour un autre : tout est à refaire
+    if (lastSmoothIterations != 0 && lastSmoothIterations != iterations) {
+        markAllDirty();
+    }
+    lastSmoothIterations = iterations;
+
+    // 1. Fermeture de chaque tuile modifiée, élargie de la marge (zone à corriger), calculée sur
+    // une zone encore élargie de la marge (contexte) : sur la zone à corriger, le résultat est
+    // celui de la fermeture de toute la grille. Tous les masques sont calculés avant d'écrire
+    // dans la grille, comme avec un seul masque global.
+    // Le masque des obstacles est un bitmap (PackedTriStateGrid, 64 cases par mot) : la fermeture
+    // se fait par décalages et opérations bit à bit, 64 cases à la fois.
+    std::vector<cv::Rect> regions;
+    std::vector<cv::Rect> contexts;
+    std::vector<std::vector<uint64_t>> filledMasks;
+    cv::Mat contextCells;
+    PackedTriStateGrid contextBits;
+    regions.reserve(smoothDirtyTiles.size());
+    contexts.reserve(smoothDirtyTiles.size());
+    filledMasks.reserve(smoothDirtyTiles.size());
+    for (int tile : smoothDirtyTiles) {
+        cv::Rect region = tileRect(tile);
+        region = cv::Rect(region.x - halo, region.y - halo, region.width + 2 * halo, region.height + 2 * halo) & gridRect;
+        cv::Rect context = cv::Rect(region.x - halo, region.y - halo, region.width + 2 * halo, region.height + 2 * halo) & gridRect;
+
+        // Cases du contexte, compactées : le bitmap des obstacles sert de masque
+        copyCells(context, contextCells);
+        contextBits.pack(contextCells);
+
+        // Application de la "Fermeture" (Closing) morphologique (carré de 3x3 cases)
+        // Fermeture = Dilatation suivie d'une Érosion.
+        // Cela permet de relier les points noirs proches et de combler les petits interstices.
+        std::vector<uint64_t> filled;
+        contextBits.closeObstacles(iterations, filled);
+
+        // On ne garde que les cases bouchées : obstacles après la fermeture, pas avant
+        const int stride = contextBits.getStride();
+        for (int y = 0; y < context.height; y++) {
+            const uint64_t* occupied = contextBits.getOccupiedRow(y);
+            for (int k = 0; k < stride; k++) {
+                filled[static_cast<size_t>(y) * stride + k] &= ~occupied[k];
+            }
+        }
+
+        regions.push_back(region);
+        contexts.push_back(context);
+        filledMasks.push_back(std::move(filled));
+        smoothDirty[tile] = 0;
+    }
+    smoothDirtyTiles.clear();
+
+    // 2. Réapplication des masques nettoyés sur la grille principale
     // Partout où le masque dit "Obstacle", on force la grille à 0 (Noir).
-    grid.setTo(0, obstacleMask);
+    // (Seulement les bits à 1 des cases bouchées : on compte au passage les cases qui changent)
+    for (size_t k = 0; k < regions.size(); k++) {
+        const cv::Rect& region = regions[k];
+        const cv::Rect& context = contexts[k];
+        const int stride = (context.width + 63) / 64;
+        const int x0 = region.x - context.x; // Colonnes de la zone à corriger dans le contexte
+        const int x1 = x0 + region.width;
+        for (int gy = region.y; gy < region.y + region.height; gy++) {
+            const uint64_t* maskRow = &filledMasks[k][static_cast<size_t>(gy - context.y) * stride];
+            for (int word = x0 >> 6; word <= (x1 - 1) >> 6; word++) {
+                for (uint64_t bits = maskRow[word]; bits != 0; bits &= bits - 1) {
+                    const int x = (word << 6) + lowestSetBit(bits);
+                    if (x < x0 || x >= x1) {
+                        continue;
+                    }
+                    const int gx = context.x + x;
+                    const int tile = tileIndex(gx, gy);
+                    Tile* t = tileAt(tile);
+                    uchar& cell = t->cells[cellOffset(gx, gy)];
+                    if (cell != 0) {
+                        if (cell == 127) {
+                            unknownCount--;
+                        } else if (cell == 255) {
+                            freeCount--;
+                        }
+                        cell = 0;
+                        // Mode LOG_ODDS : la case bouchée devient un obstacle aussi pour les log-odds
+                        if (mode == OccupancyMode::LOG_ODDS) {
+                            int16_t& value = t->logOdds[cellOffset(gx, gy)];
+                            value = std::max(value, logOddsParams.occupiedThreshold);
+                        }
+                        // Seulement à redessiner : la zone est déjà fermée
+                        markTileDirty(tile, false);
+                    }
+                }
+            }
+        }
+    }
 }
 
 // =========================================================
 // ANALYSE D'EXPLORATION
 // =========================================================
 bool OccupancyGrid::isFullyExplored() const {
-    
-    int unexploredCount = 0; // Compteur de cases grises
-    
-    // Parcours de toute la grille
-    for (int y = 0; y < gridH; y++) {
-        for (int x = 0; x < gridW; x++) {
-            // Lecture de la valeur du pixel
-            uchar value = grid.at<uchar>(y, x);
-            
-            // Si c'est gris (127), c'est inexploré
-            if (value == 127) { 
-                unexploredCount++;
+    // Ratio de cases grises tenu à jour par markFree / markOccupied / smoothGrid :
+    // plus de parcours de toute la grille à chaque tick.
+    // Par défaut, sous 31.1% de gris, on considère que c'est fini.
+    // (Valeur empirique pour tolérer les zones inaccessibles derrière les murs)
+    return getUnknownRatio() < explorationThreshold;
+}
+
+void OccupancyGrid::setExplorationThreshold(double unknownRatio) {
+    explorationThreshold = unknownRatio;
+}
+
+bool OccupancyGrid::setCells(const cv::Mat& cells) {
+    if (cells.rows != gridH || cells.cols != gridW || cells.type() != CV_8UC1) {
+        std::cerr << "ERREUR : setCells() attend une image CV_8UC1 de " << gridW << "x" << gridH << " cases." << std::endl;
+        return false;
+    }
+
+    for (int tile = 0; tile < tilesX * tilesY; tile++) {
+        const cv::Rect rect = tileRect(tile);
+        const cv::Mat tileCells = cells(rect);
+        if (tiles[tile] == &blankTile && cv::countNonZero(tileCells != 127) == 0) {
+            continue; // Toujours inconnue : reste absente
+        }
+        Tile* t = tileAt(tile);
+        for (int y = 0; y < rect.height; y++) {
+            std::memcpy(t->cells + (y << TILE_SHIFT), tileCells.ptr<uchar>(y), rect.width);
+        }
+    }
+    contentId = nextContentId(); // Cases modifiées hors des scans
+    recount();
+    return true;
+}
+
+void OccupancyGrid::recount() {
+    unknownCount = gridW * gridH;
+    freeCount = 0;
+    for (int tile = 0; tile < tilesX * tilesY; tile++) {
+        const Tile* t = tiles[tile];
+        if (t == &blankTile) {
+            continue;
+        }
+
+        // Cases de la tuile dans la grille (les cases au-delà du bord restent inconnues)
+        const cv::Rect rect = tileRect(tile);
+        int unknown = 0;
+        for (int y = 0; y < rect.height; y++) {
+            const uchar* row = t->cells + (y << TILE_SHIFT);
+            for (int x = 0; x < rect.width; x++) {
+                if (row[x] == 127) {
+                    unknown++;
+                } else if (row[x] == 255) {
+                    freeCount++;
+                }
+            }
+        }
+        unknownCount -= rect.area() - unknown;
+
+        // Tuile redevenue entièrement inconnue (log-odds nuls) : rendue à la réserve
+        bool blank = (unknown == rect.area());
+        for (size_t i = 0; blank && i < t->logOdds.size(); i++) {
+            blank = (t->logOdds[i] == 0);
+        }
+        if (blank) {
+            releaseTile(tile);
+        }
+    }
+    markAllDirty();
+}
+
+// =========================================================
+// REQUÊTES DE ZONE (Pyramide multi-résolution)
+// =========================================================
+uchar OccupancyGrid::getRegionStates(const cv::Rect& cells, uchar stopStates) const {
+    const cv::Rect region = cells & cv::Rect(0, 0, gridW, gridH);
+    if (region.empty()) {
+        return 0;
+    }
+    refreshPyramid();
+
+    // Descente depuis le sommet (un seul nœud, qui couvre toute la grille)
+    uchar found = 0;
+    collectRegionStates(pyramid.getLevels(), 0, 0, region, stopStates, found);
+    return found;
+}
+
+bool OccupancyGrid::hasUnknown(const cv::Rect& cells) const {
+    return (getRegionStates(cells, REGION_UNKNOWN) & REGION_UNKNOWN) != 0;
+}
+
+bool OccupancyGrid::hasObstacle(const cv::Rect& cells) const {
+    return (getRegionStates(cells, REGION_OCCUPIED) & REGION_OCCUPIED) != 0;
+}
+
+bool OccupancyGrid::isRegionFree(const cv::Rect& cells) const {
+    // Arrêt au premier état qui n'est pas "libre"
+    return getRegionStates(cells, REGION_UNKNOWN | REGION_OCCUPIED) == REGION_FREE;
+}
+
+uchar OccupancyGrid::getCoarseStates(int level, int nx, int ny) const {
+    if (level < 0 || level > pyramid.getLevels() || nx < 0 || ny < 0) {
+        return 0;
+    }
+    if (level == 0) {
+        return (nx < gridW && ny < gridH) ? regionStateOf(getCell(nx, ny)) : 0;
+    }
+    if (nx >= pyramid.getLevelWidth(level) || ny >= pyramid.getLevelHeight(level)) {
+        return 0;
+    }
+    refreshPyramid();
+    return pyramid.getStates(level, nx, ny);
+}
+
+void OccupancyGrid::refreshPyramid() const {
+    for (int tile : pyramidDirtyTiles) {
+        // Une tuile absente donne ses cases inconnues (tuile partagée)
+        pyramid.updateRegion(tileRect(tile), tiles[tile]->cells, TILE_SIZE);
+        pyramidDirty[tile] = 0;
+    }
+    pyramidDirtyTiles.clear();
+}
+
+void OccupancyGrid::collectRegionStates(int level, int nx, int ny, const cv::Rect& cells, uchar stopStates, uchar& found) const {
+    const uchar states = (level == 0) ? regionStateOf(tiles[tileIndex(nx, ny)]->cells[cellOffset(nx, ny)])
+                                      : pyramid.getStates(level, nx, ny);
+
+    // Aucun état nouveau sous ce nœud : inutile de descendre
+    if ((states & ~found) == 0) {
+        return;
+    }
+
+    // Nœud uniforme (un seul état), ou entièrement dans la zone (sa partie dans la grille) :
+    // tous ses états sont présents dans la zone (le nœud touche toujours la zone)
+    const int x0 = nx << level;
+    const int y0 = ny << level;
+    const int x1 = std::min(x0 + (1 << level), gridW);
+    const int y1 = std::min(y0 + (1 << level), gridH);
+    const bool uniform = (states & (states - 1)) == 0;
+    if (uniform || (x0 >= cells.x && y0 >= cells.y && x1 <= cells.x + cells.width && y1 <= cells.y + cells.height)) {
+        found |= states;
+        return;
+    }
+
+    // Sinon : les nœuds du niveau inférieur qui touchent la zone
+    const int child = level - 1;
+    const int half = 1 << child;
+    for (int cy = 2 * ny; cy <= 2 * ny + 1; cy++) {
+        const int cy0 = cy << child;
+        if (cy0 >= cells.y + cells.height || cy0 + half <= cells.y) {
+            continue;
+        }
+        for (int cx = 2 * nx; cx <= 2 * nx + 1; cx++) {
+            const int cx0 = cx << child;
+            if (cx0 >= cells.x + cells.width || cx0 + half <= cells.x) {
+                continue;
+            }
+            collectRegionStates(child, cx, cy, cells, stopStates, found);
+            if (found & stopStates) {
+                return;
             }
         }
     }
-    
-    // Calcul du ratio : (Nombre de cases grises) / (Nombre total de cases)
-    int totalCells = gridW * gridH;
-    double unexploredRatio = (double)unexploredCount / totalCells;
-    
-    // Si moins de 31.1% de la carte est grise, on considère que c'est fini.
-    // (Valeur empirique pour tolérer les zones inaccessibles derrière les murs)
-    return unexploredRatio < 0.311; 
 }
 
 // =========================================================
 // AFFICHAGE (Rendu Graphique)
 // =========================================================
 void OccupancyGrid::draw(cv::Mat& displayImage) {
-    // Initialise l'image de sortie avec un fond gris
-    // CV_8UC3 = Image couleur 3 canaux (pour pouvoir afficher en BGR)
-    displayImage = cv::Mat(height, width, CV_8UC3, cv::Scalar(127, 127, 127));
-
-    // Parcours de chaque case de la grille logique
-    for (int y = 0; y < gridH; y++) {
-        for (int x = 0; x < gridW; x++) {
-            
-            // Récupère la valeur logique (0, 127, 255)
-            uchar value = grid.at<uchar>(y, x);
-            cv::Scalar color;
-            
-            // Choix de la couleur d'affichage
+    if (view.empty()) {
+        // Première image : fond gris puis toutes les cases
+        // CV_8UC3 = Image couleur 3 canaux (pour pouvoir afficher en BGR)
+        // (les tuiles absentes sont entièrement inconnues : déjà dessinées par le fond)
+        view = cv::Mat(height, width, CV_8UC3, cv::Scalar(127, 127, 127));
+        for (int tile = 0; tile < tilesX * tilesY; tile++) {
+            if (tiles[tile] != &blankTile) {
+                renderTile(tile);
+            }
+        }
+        for (int tile : renderDirtyTiles) {
+            renderDirty[tile] = 0;
+        }
+    } else {
+        // Ensuite : seulement les tuiles modifiées depuis l'image précédente
+        for (int tile : renderDirtyTiles) {
+            renderTile(tile);
+            renderDirty[tile] = 0;
+        }
+    }
+    renderDirtyTiles.clear();
+
+    // L'appelant dessine par-dessus (robot) : il reçoit une copie de l'image gardée
+    view.copyTo(displayImage);
+}
+
+// Couleur d'affichage (BGR) de chaque valeur possible d'une case, calculée une seule fois :
+// plus de test par case au moment du rendu
+struct CellPalette {
+    uchar bgr[256][3];
+    CellPalette() {
+        for (int value = 0; value < 256; value++) {
+            uchar gray;
             if (value == 255) {
-                color = cv::Scalar(255, 255, 255); // Blanc pour Libre
+                gray = 255; // Blanc pour Libre
             } else if (value == 0) {
-                color = cv::Scalar(0, 0, 0);       // Noir pour Obstacle
+                gray = 0;   // Noir pour Obstacle
             } else {
-                color = cv::Scalar(127, 127, 127); // Gris pour Inconnu
+                gray = 127; // Gris pour Inconnu
             }
+            bgr[value][0] = bgr[value][1] = bgr[value][2] = gray;
+        }
+    }
+};
+static const CellPalette cellPalette;
+
+void OccupancyGrid::renderTile(int tile) {
+    renderCells(tiles[tile]->cells, tileRect(tile), cellSize, view);
+}
+
+void OccupancyGrid::renderCells(const uchar* tileCells, const cv::Rect& cells, int cellSize, cv::Mat& view) {
+    const int rowBytes = cells.width * cellSize * 3; // Octets d'une ligne de pixels du rectangle
 
-            // Calcul du rectangle correspondant sur l'image finale
+    // Parcours de chaque ligne de la tuile
+    for (int y = cells.y; y < cells.y + cells.height; y++) {
+        const uchar* values = tileCells + ((y - cells.y) << TILE_SHIFT);
+        uchar* out = view.ptr<uchar>(y * cellSize) + cells.x * cellSize * 3;
+
+        // Première ligne de pixels de la case : couleur lue dans la table
+        if (cellSize == 1) {
+            for (int x = 0; x < cells.width; x++) {
+                const uchar* color = cellPalette.bgr[values[x]];
+                out[3 * x] = color[0];
+                out[3 * x + 1] = color[1];
+                out[3 * x + 2] = color[2];
+            }
+        } else {
             // On multiplie par cellSize pour "upscaler" la grille vers la résolution d'écran
-            cv::Rect rect(x * cellSize, y * cellSize, cellSize, cellSize);
-            
-            // Dessin du rectangle plein
-            cv::rectangle(displayImage, rect, color, cv::FILLED);
+            // (plus proche voisin : chaque case devient un carré de cellSize x cellSize pixels)
+            uchar* pixel = out;
+            for (int x = 0; x < cells.width; x++) {
+                const uchar* color = cellPalette.bgr[values[x]];
+                for (int k = 0; k < cellSize; k++, pixel += 3) {
+                    pixel[0] = color[0];
+                    pixel[1] = color[1];
+                    pixel[2] = color[2];
+                }
+            }
+            // Lignes suivantes de la case : copies de la première
+            for (int k = 1; k < cellSize; k++) {
+                std::memcpy(view.ptr<uchar>(y * cellSize + k) + cells.x * cellSize * 3, out, rowBytes);
+            }
+        }
+    }
+}
+
+// =========================================================
+// SUIVI DES ZONES MODIFIÉES (Tuiles)
+// =========================================================
+void OccupancyGrid::markAllDirty() {
+    for (int tile = 0; tile < tilesX * tilesY; tile++) {
+        if (!renderDirty[tile]) {
+            renderDirty[tile] = 1;
+            renderDirtyTiles.push_back(tile);
+        }
+        if (!smoothDirty[tile]) {
+            smoothDirty[tile] = 1;
+            smoothDirtyTiles.push_back(tile);
+        }
+        if (!pyramidDirty[tile]) {
+            pyramidDirty[tile] = 1;
+            pyramidDirtyTiles.push_back(tile);
         }
     }
 }
 
+// =========================================================
+// STOCKAGE PAR TUILES (Allocation à la première écriture)
+// =========================================================
+OccupancyGrid::Tile* OccupancyGrid::prepareTile(int tile) {
+    if (tiles[tile] == &blankTile) {
+        return allocateTile(tile);
+    }
+
+    // Gardée par un instantané : copiée, sauf si plus aucun instantané ne la garde.
+    // Seul ce thread crée des références (publishSnapshot()) : un compte de 1 ne peut pas remonter.
+    if (tileOwners[tile].use_count() > 1) {
+        std::shared_ptr<Tile> copy = newTile();
+        std::memcpy(copy->cells, tileOwners[tile]->cells, sizeof(copy->cells));
+        copy->logOdds = tileOwners[tile]->logOdds;
+        tileOwners[tile] = copy;
+        tiles[tile] = copy.get();
+        copiedTiles++;
+    } else {
+        // Les lectures du dernier lecteur (avant qu'il rende la tuile) précèdent nos écritures
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    tileWritable[tile] = 1;
+    return tiles[tile];
+}
+
+OccupancyGrid::Tile* OccupancyGrid::allocateTile(int tile) {
+    std::shared_ptr<Tile> owner = newTile();
+    Tile* t = owner.get();
+
+    // Cases inconnues ; log-odds nuls seulement en mode LOG_ODDS
+    std::memset(t->cells, 127, sizeof(t->cells));
+    if (mode == OccupancyMode::LOG_ODDS) {
+        t->logOdds.assign(TILE_CELLS, 0);
+    } else {
+        t->logOdds.clear();
+    }
+
+    tileOwners[tile] = std::move(owner);
+    tiles[tile] = t;
+    tileWritable[tile] = 1;
+    allocatedTiles++;
+    return t;
+}
+
+std::shared_ptr<OccupancyGrid::Tile> OccupancyGrid::newTile() {
+    if (!tilePool.empty()) {
+        // Réutilisation d'une tuile rendue (pas d'appel à l'allocateur)
+        std::shared_ptr<Tile> t = std::move(tilePool.back());
+        tilePool.pop_back();
+        return t;
+    }
+    return std::make_shared<Tile>();
+}
+
+void OccupancyGrid::releaseTile(int tile) {
+    // Une tuile gardée par un instantané reste à lui (libérée avec le dernier instantané)
+    if (tileOwners[tile].use_count() == 1) {
+        tilePool.push_back(std::move(tileOwners[tile]));
+    }
+    tileOwners[tile].reset();
+    tiles[tile] = &blankTile;
+    tileWritable[tile] = 0;
+    allocatedTiles--;
+}
+
+void OccupancyGrid::setCell(int tile, int offset, uchar value) {
+    uchar& cell = tileAt(tile)->cells[offset];
+    unknownCount += (value == 127) - (cell == 127);
+    freeCount += (value == 255) - (cell == 255);
+
+    // À lisser seulement si un obstacle apparaît ou disparaît
+    markTileDirty(tile, value == 0 || cell == 0);
+    cell = value;
+}
+
+void OccupancyGrid::copyCells(const cv::Rect& cells, cv::Mat& out) const {
+    out.create(cells.height, cells.width, CV_8UC1);
+    const int end = cells.x + cells.width;
+    for (int y = 0; y < cells.height; y++) {
+        const int gy = cells.y + y;
+        uchar* row = out.ptr<uchar>(y);
+
+        // Morceau de ligne par tuile traversée (une tuile absente copie la tuile inconnue)
+        for (int x = cells.x; x < end; ) {
+            const int segmentEnd = std::min(end, ((x >> TILE_SHIFT) + 1) << TILE_SHIFT);
+            std::memcpy(row + (x - cells.x), tiles[tileIndex(x, gy)]->cells + cellOffset(x, gy), segmentEnd - x);
+            x = segmentEnd;
+        }
+    }
+}
+
+cv::Rect OccupancyGrid::tileRect(int tile) const {
+    const int x = (tile % tilesX) * TILE_SIZE;
+    const int y = (tile / tilesX) * TILE_SIZE;
+    return cv::Rect(x, y, std::min(TILE_SIZE, gridW - x), std::min(TILE_SIZE, gridH - y));
+}
+
+// =========================================================
+// INSTANTANÉS (Lecture depuis d'autres threads)
+// =========================================================
+std::shared_ptr<const OccupancySnapshot> OccupancyGrid::publishSnapshot() {
+    std::shared_ptr<OccupancySnapshot> snapshot(new OccupancySnapshot());
+    snapshot->sequence = ++snapshotSequence;
+    snapshot->gridW = gridW;
+    snapshot->gridH = gridH;
+    snapshot->cellSize = cellSize;
+    snapshot->width = width;
+    snapshot->height = height;
+    snapshot->tilesX = tilesX;
+    snapshot->mode = mode;
+    snapshot->unknownCount = unknownCount;
+    snapshot->freeCount = freeCount;
+
+    // Tuiles partagées : la prochaine écriture dans chacune d'elles en fera une copie
+    snapshot->tiles.resize(tiles.size());
+    for (size_t tile = 0; tile < tiles.size(); tile++) {
+        if (tiles[tile] != &blankTile) {
+            snapshot->tiles[tile] = tileOwners[tile];
+            tileWritable[tile] = 0;
+        }
+    }
+
+    std::shared_ptr<const OccupancySnapshot> published = snapshot;
+    {
+        std::lock_guard<std::mutex> lock(snapshotMutex);
+        latestSnapshot.swap(published); // L'ancien instantané est rendu hors du verrou
+    }
+    return snapshot;
+}
+
+std::shared_ptr<const OccupancySnapshot> OccupancyGrid::getSnapshot() const {
+    std::lock_guard<std::mutex> lock(snapshotMutex);
+    return latestSnapshot;
+}
+
 // =========================================================
 // GETTERS
 // =========================================================
 
-// Retourne une référence vers la matrice brute
-cv::Mat& OccupancyGrid::getGrid() {
-    return grid;
+// Copie dense de toutes les tuiles
+cv::Mat OccupancyGrid::getGrid() const {
+    cv::Mat cells;
+    copyCells(cv::Rect(0, 0, gridW, gridH), cells);
+    return cells;
+}
+
+uchar OccupancyGrid::getCell(int gx, int gy) const {
+    if (gx < 0 || gx >= gridW || gy < 0 || gy >= gridH) {
+        return 127;
+    }
+    return tiles[tileIndex(gx, gy)]->cells[cellOffset(gx, gy)];
+}
+
+void OccupancyGrid::toPacked(PackedTriStateGrid& packed) const {
+    packed.reset(gridW, gridH); // Tout inconnu : les tuiles vides n'ont rien à écrire
+    for (int tile = 0; tile < static_cast<int>(tiles.size()); tile++) {
+        const Tile* t = tiles[tile];
+        if (t == &blankTile) {
+            continue;
+        }
+        const cv::Rect rect = tileRect(tile);
+        for (int y = 0; y < rect.height; y++) {
+            packed.packRow(rect.y + y, rect.x, t->cells + (y << TILE_SHIFT), rect.width);
+        }
+    }
+}
+
+int OccupancyGrid::getPyramidLevels() const {
+    return pyramid.getLevels();
+}
+
+// Mémoire occupée par les tuiles
+int OccupancyGrid::getAllocatedTileCount() const {
+    return allocatedTiles;
+}
+
+size_t OccupancyGrid::getCellMemoryBytes() const {
+    const size_t bytesPerCell = (mode == OccupancyMode::LOG_ODDS) ? 1 + sizeof(int16_t) : 1;
+    return static_cast<size_t>(allocatedTiles) * TILE_CELLS * bytesPerCell;
+}
+
+// Retourne le nombre de cases écrites par le dernier update()
+int OccupancyGrid::getLastUpdateCellCount() const {
+    return lastUpdateCells;
+}
+
+// Compteurs d'états des cases
+int OccupancyGrid::getUnknownCount() const {
+    return unknownCount;
+}
+
+int OccupancyGrid::getFreeCount() const {
+    return freeCount;
+}
+
+int OccupancyGrid::getOccupiedCount() const {
+    return gridW * gridH - unknownCount - freeCount;
+}
+
+double OccupancyGrid::getUnknownRatio() const {
+    int totalCells = gridW * gridH;
+    return (totalCells > 0) ? static_cast<double>(unknownCount) / totalCells : 0.0;
+}
+
+double OccupancyGrid::getExplorationThreshold() const {
+    return explorationThreshold;
+}
+
+// Mode probabiliste
+uint64_t OccupancyGrid::getContentId() const {
+    return contentId;
+}
+
+OccupancyMode OccupancyGrid::getMode() const {
+    return mode;
+}
+
+const LogOddsConfig& OccupancyGrid::getLogOddsConfig() const {
+    return logOddsConfig;
+}
+
+int OccupancyGrid::getLogOdds(int gx, int gy) const {
+    if (mode != OccupancyMode::LOG_ODDS || gx < 0 || gx >= gridW || gy < 0 || gy >= gridH) {
+        return 0;
+    }
+    const Tile* t = tiles[tileIndex(gx, gy)];
+    return (t != &blankTile) ? t->logOdds[cellOffset(gx, gy)] : 0;
+}
+
+// Tuiles en attente
+int OccupancyGrid::getRenderDirtyTileCount() const {
+    return static_cast<int>(renderDirtyTiles.size());
+}
+
+int OccupancyGrid::getSmoothDirtyTileCount() const {
+    return static_cast<int>(smoothDirtyTiles.size());
+}
+
+// Tuiles copiées à cause d'un instantané
+int OccupancyGrid::getCopiedTileCount() const {
+    return copiedTiles;
 }
\ No newline at end of file
@@ -0,0 +1,349 @@
+#include "../include/OccupancyLog.hpp"
+#include "../include/OccupancyGrid.hpp"
+#include "../include/OccupancySnapshot.hpp"
+#include "../include/Varint.hpp"
+#include <algorithm>
+#include <iostream>
+#include <cstring>
+
+// =========================================================
+// OUTILS (Codes des cases, voir Varint.hpp pour les entiers)
+// =========================================================
+static const char LOG_MAGIC[4] = { 'O', 'G', 'L', '1' };
+static const uint8_t RECORD_KEYFRAME = 'K';
+static const uint8_t RECORD_DELTA = 'D';
+
+// Code d'une case (0 : inconnu, 1 : libre, 2 : obstacle) et valeur d'un code
+static inline uint8_t codeOf(uchar cell) {
+    return (cell == 127) ? 0 : (cell == 255) ? 1 : 2;
+}
+static const uchar CELL_OF_CODE[3] = { 127, 255, 0 };
+
+// =========================================================
+// ÉCRITURE
+// =========================================================
+OccupancyLogWriter::OccupancyLogWriter()
+    : keyframeInterval(100), tickCount(0), bytesWritten(0) {}
+
+OccupancyLogWriter::~OccupancyLogWriter() {
+    close();
+}
+
+bool OccupancyLogWriter::open(const std::string& path, int interval) {
+    close();
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "ERREUR : Impossible de creer le journal de grille '" << path << "'" << std::endl;
+        return false;
+    }
+    keyframeInterval = std::max(1, interval);
+    tickCount = 0;
+    bytesWritten = 0;
+    return true;
+}
+
+void OccupancyLogWriter::close() {
+    if (out.is_open()) {
+        out.close();
+    }
+    previous.reset();
+}
+
+void OccupancyLogWriter::writeTick(OccupancyGrid& grid) {
+    if (!out.is_open()) {
+        return;
+    }
+
+    // Vue figée du tick : les tuiles non modifiées depuis le tick précédent sont partagées
+    std::shared_ptr<const OccupancySnapshot> snapshot = grid.publishSnapshot();
+    if (tickCount == 0) {
+        writeHeader(*snapshot);
+    }
+
+    // Image clé au premier tick, puis tous les keyframeInterval ticks
+    if (tickCount % keyframeInterval == 0) {
+        encodeKeyframe(*snapshot);
+        writeRecord(RECORD_KEYFRAME, tickCount);
+    } else {
+        encodeDelta(*snapshot);
+        writeRecord(RECORD_DELTA, tickCount);
+    }
+    previous = snapshot;
+    tickCount++;
+}
+
+void OccupancyLogWriter::writeHeader(const OccupancySnapshot& snapshot) {
+    payload.assign(LOG_MAGIC, LOG_MAGIC + 4);
+    putVarint(payload, snapshot.getGridWidth());
+    putVarint(payload, snapshot.getGridHeight());
+    putVarint(payload, snapshot.getCellSize());
+    putVarint(payload, keyframeInterval);
+    out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    bytesWritten += payload.size();
+}
+
+void OccupancyLogWriter::encodeKeyframe(const OccupancySnapshot& snapshot) {
+    payload.clear();
+    snapshot.copyTo(after);
+
+    // Plages de cases de même état, ligne après ligne (une plage peut continuer sur la ligne suivante)
+    uint8_t code = 0;
+    uint64_t length = 0;
+    for (int y = 0; y < after.rows; y++) {
+        const uchar* row = after.ptr<uchar>(y);
+        for (int x = 0; x < after.cols; x++) {
+            const uint8_t c = codeOf(row[x]);
+            if (c == code && length > 0) {
+                length++;
+                continue;
+            }
+            if (length > 0) {
+                putVarint(payload, ((length - 1) << 2) | code);
+            }
+            code = c;
+            length = 1;
+        }
+    }
+    if (length > 0) {
+        putVarint(payload, ((length - 1) << 2) | code);
+    }
+}
+
+void OccupancyLogWriter::encodeDelta(const OccupancySnapshot& snapshot) {
+    // Cases changées : seules les tuiles qui ne sont plus partagées avec le tick précédent
+    // sont comparées case par case
+    changes.clear();
+    const int gridW = snapshot.getGridWidth();
+    for (int tile = 0; tile < snapshot.getTileCount(); tile++) {
+        if (snapshot.sameTile(*previous, tile)) {
+            continue;
+        }
+        const cv::Rect rect = snapshot.getTileRect(tile);
+        previous->copyRegion(rect, before);
+        snapshot.copyRegion(rect, after);
+        for (int y = 0; y < rect.height; y++) {
+            const uchar* oldRow = before.ptr<uchar>(y);
+            const uchar* newRow = after.ptr<uchar>(y);
+            for (int x = 0; x < rect.width; x++) {
+                if (oldRow[x] != newRow[x]) {
+                    changes.push_back(std::make_pair((rect.y + y) * gridW + rect.x + x, codeOf(newRow[x])));
+                }
+            }
+        }
+    }
+
+    // Ordre de la grille (ligne par ligne), puis plages de cases consécutives de même état
+    std::sort(changes.begin(), changes.end());
+    size_t runs = 0;
+    for (size_t i = 0; i < changes.size(); i++) {
+        if (i == 0 || changes[i].first != changes[i - 1].first + 1 || changes[i].second != changes[i - 1].second) {
+            runs++;
+        }
+    }
+
+    payload.clear();
+    putVarint(payload, runs);
+    int runEnd = 0; // Fin (exclue) de la plage précédente
+    for (size_t i = 0; i < changes.size(); ) {
+        size_t j = i + 1;
+        while (j < changes.size() && changes[j].first == changes[j - 1].first + 1 && changes[j].second == changes[i].second) {
+            j++;
+        }
+        putVarint(payload, (static_cast<uint64_t>(changes[i].first - runEnd) << 2) | changes[i].second);
+        putVarint(payload, j - i - 1);
+        runEnd = changes[i].first + static_cast<int>(j - i);
+        i = j;
+    }
+}
+
+void OccupancyLogWriter::writeRecord(uint8_t type, int tick) {
+    std::vector<uint8_t> header;
+    header.push_back(type);
+    putVarint(header, tick);
+    putVarint(header, payload.size());
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+    bytesWritten += header.size() + payload.size();
+}
+
+bool OccupancyLogWriter::isOpen() const {
+    return out.is_open();
+}
+
+int OccupancyLogWriter::getTickCount() const {
+    return tickCount;
+}
+
+size_t OccupancyLogWriter::getBytesWritten() const {
+    return bytesWritten;
+}
+
+// =========================================================
+// LECTURE
+// =========================================================
+OccupancyLogReader::OccupancyLogReader()
+    : gridW(0), gridH(0), cellSize(1), keyframeInterval(0), currentTick(-1) {}
+
+bool OccupancyLogReader::open(const std::string& path) {
+    in.close();
+    in.clear();
+    records.clear();
+    cells.release();
+    currentTick = -1;
+
+    in.open(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "ERREUR : Impossible d'ouvrir le journal de grille '" << path << "'" << std::endl;
+        return false;
+    }
+    in.seekg(0, std::ios::end);
+    const std::streamoff fileSize = in.tellg();
+    in.seekg(0, std::ios::beg);
+
+    // En-tête
+    char magic[4];
+    uint64_t w, h, size, interval;
+    if (!in.read(magic, 4) || std::memcmp(magic, LOG_MAGIC, 4) != 0 ||
+        !readVarint(in, w) || !readVarint(in, h) || !readVarint(in, size) || !readVarint(in, interval) ||
+        w == 0 || h == 0 || w * h > 0x7FFFFFFF) {
+        std::cerr << "ERREUR : '" << path << "' n'est pas un journal de grille valide." << std::endl;
+        in.close();
+        return false;
+    }
+    gridW = static_cast<int>(w);
+    gridH = static_cast<int>(h);
+    cellSize = static_cast<int>(size);
+    keyframeInterval = static_cast<int>(interval);
+
+    // Index des enregistrements : on saute les données grâce à leur taille
+    while (true) {
+        const int type = in.get();
+        uint64_t tick, dataSize;
+        if (type == std::char_traits<char>::eof() || !readVarint(in, tick) || !readVarint(in, dataSize)) {
+            break;
+        }
+        const std::streamoff data = in.tellg();
+        if ((type != RECORD_KEYFRAME && type != RECORD_DELTA) || tick != records.size() ||
+            dataSize > static_cast<uint64_t>(fileSize - data)) {
+            break; // Fin tronquée (ou corrompue) : on garde les enregistrements complets
+        }
+        records.push_back(Record{ static_cast<uint8_t>(type), data, static_cast<size_t>(dataSize) });
+        in.seekg(data + static_cast<std::streamoff>(dataSize));
+    }
+    in.clear();
+    return true;
+}
+
+bool OccupancyLogReader::seek(int tick) {
+    if (tick < 0 || tick >= static_cast<int>(records.size())) {
+        return false;
+    }
+
+    // Image clé la plus proche avant le tick
+    int key = tick;
+    while (key >= 0 && records[key].type != RECORD_KEYFRAME) {
+        key--;
+    }
+    if (key < 0) {
+        return false;
+    }
+
+    // On repart de l'état courant s'il est entre cette image clé et le tick
+    const int start = (currentTick >= key && currentTick <= tick) ? currentTick + 1 : key;
+    for (int t = start; t <= tick; t++) {
+        if (!apply(t)) {
+            currentTick = -1;
+            return false;
+        }
+    }
+    currentTick = tick;
+    return true;
+}
+
+bool OccupancyLogReader::apply(int tick) {
+    const Record& record = records[tick];
+    payload.resize(record.size);
+    in.clear();
+    in.seekg(record.data);
+    if (!in.read(reinterpret_cast<char*>(payload.data()), record.size)) {
+        return false;
+    }
+    const uint8_t* pos = payload.data();
+    const uint8_t* end = pos + record.size;
+    const uint64_t total = static_cast<uint64_t>(gridW) * gridH;
+
+    if (record.type == RECORD_KEYFRAME) {
+        // Toute la grille, plage par plage (matrice continue : cases numérotées ligne par ligne)
+        cells.create(gridH, gridW, CV_8UC1);
+        uchar* base = cells.ptr<uchar>(0);
+        uint64_t index = 0;
+        while (index < total) {
+            uint64_t value;
+            if (!getVarint(pos, end, value)) {
+                return false;
+            }
+            const uint8_t code = value & 3;
+            const uint64_t length = (value >> 2) + 1;
+            if (code > 2 || length > total - index) {
+                return false;
+            }
+            std::memset(base + index, CELL_OF_CODE[code], static_cast<size_t>(length));
+            index += length;
+        }
+        return true;
+    }
+
+    // Changements depuis le tick précédent
+    if (cells.empty()) {
+        return false;
+    }
+    uchar* base = cells.ptr<uchar>(0);
+    uint64_t runs;
+    if (!getVarint(pos, end, runs)) {
+        return false;
+    }
+    uint64_t index = 0;
+    for (uint64_t r = 0; r < runs; r++) {
+        uint64_t value, length;
+        if (!getVarint(pos, end, value) || !getVarint(pos, end, length)) {
+            return false;
+        }
+        const uint8_t code = value & 3;
+        index += value >> 2;
+        length += 1;
+        if (code > 2 || index > total || length > total - index) {
+            return false;
+        }
+        std::memset(base + index, CELL_OF_CODE[code], static_cast<size_t>(length));
+        index += length;
+    }
+    return true;
+}
+
+const cv::Mat& OccupancyLogReader::getCells() const {
+    return cells;
+}
+
+int OccupancyLogReader::getTickCount() const {
+    return static_cast<int>(records.size());
+}
+
+int OccupancyLogReader::getCurrentTick() const {
+    return currentTick;
+}
+
+int OccupancyLogReader::getGridWidth() const {
+    return gridW;
+}
+
+int OccupancyLogReader::getGridHeight() const {
+    return gridH;
+}
+
+int OccupancyLogReader::getCellSize() const {
+    return cellSize;
+}
+
+int OccupancyLogReader::getKeyframeInterval() const {
+    return keyframeInterval;
+}
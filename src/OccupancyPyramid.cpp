@@ -0,0 +1,107 @@
+#include "../include/OccupancyPyramid.hpp"
+#include <algorithm>
+
+// =========================================================
+// CONSTRUCTEUR
+// =========================================================
+OccupancyPyramid::OccupancyPyramid(int w, int h) {
+    reset(w, h);
+}
+
+void OccupancyPyramid::reset(int w, int h) {
+    gridW = std::max(0, w);
+    gridH = std::max(0, h);
+    levels.clear();
+    levelW.clear();
+    levelH.clear();
+    if (gridW == 0 || gridH == 0) {
+        return;
+    }
+
+    // Niveaux jusqu'au premier qui tient en un seul nœud (toutes les cases inconnues)
+    for (int k = 1; ; k++) {
+        const int w = (gridW + (1 << k) - 1) >> k;
+        const int h = (gridH + (1 << k) - 1) >> k;
+        levelW.push_back(w);
+        levelH.push_back(h);
+        levels.push_back(std::vector<uchar>(static_cast<size_t>(w) * h, REGION_UNKNOWN));
+        if (w == 1 && h == 1) {
+            break;
+        }
+    }
+}
+
+// =========================================================
+// MISE À JOUR (Du niveau 1 vers le sommet)
+// =========================================================
+void OccupancyPyramid::updateRegion(const cv::Rect& cells, const uchar* cellRows, int stride) {
+    const cv::Rect region = cells & cv::Rect(0, 0, gridW, gridH);
+    if (region.empty() || levels.empty()) {
+        return;
+    }
+    const int x1 = region.x + region.width;  // Fin (exclue) du rectangle
+    const int y1 = region.y + region.height;
+
+    // Niveau 1 : OU des états des 2x2 cases (moins en bord de grille)
+    std::vector<uchar>& first = levels[0];
+    for (int ny = region.y >> 1; ny <= (y1 - 1) >> 1; ny++) {
+        const int gy0 = ny << 1;
+        const int gy1 = std::min(gy0 + 2, gridH);
+        for (int nx = region.x >> 1; nx <= (x1 - 1) >> 1; nx++) {
+            const int gx0 = nx << 1;
+            const int gx1 = std::min(gx0 + 2, gridW);
+            uchar states = 0;
+            for (int gy = gy0; gy < gy1; gy++) {
+                const uchar* row = cellRows + static_cast<size_t>(gy - cells.y) * stride - cells.x;
+                for (int gx = gx0; gx < gx1; gx++) {
+                    states |= regionStateOf(row[gx]);
+                }
+            }
+            first[static_cast<size_t>(ny) * levelW[0] + nx] = states;
+        }
+    }
+
+    // Niveaux suivants : OU des (au plus) 4 nœuds du niveau précédent
+    for (int k = 2; k <= static_cast<int>(levels.size()); k++) {
+        const std::vector<uchar>& below = levels[k - 2];
+        std::vector<uchar>& level = levels[k - 1];
+        const int belowW = levelW[k - 2];
+        const int belowH = levelH[k - 2];
+        for (int ny = region.y >> k; ny <= (y1 - 1) >> k; ny++) {
+            const int cy1 = std::min(2 * ny + 2, belowH);
+            for (int nx = region.x >> k; nx <= (x1 - 1) >> k; nx++) {
+                const int cx1 = std::min(2 * nx + 2, belowW);
+                uchar states = 0;
+                for (int cy = 2 * ny; cy < cy1; cy++) {
+                    for (int cx = 2 * nx; cx < cx1; cx++) {
+                        states |= below[static_cast<size_t>(cy) * belowW + cx];
+                    }
+                }
+                level[static_cast<size_t>(ny) * levelW[k - 1] + nx] = states;
+            }
+        }
+    }
+}
+
+// =========================================================
+// GETTERS
+// =========================================================
+int OccupancyPyramid::getLevels() const {
+    return static_cast<int>(levels.size());
+}
+
+int OccupancyPyramid::getLevelWidth(int level) const {
+    return levelW[level - 1];
+}
+
+int OccupancyPyramid::getLevelHeight(int level) const {
+    return levelH[level - 1];
+}
+
+size_t OccupancyPyramid::getMemoryBytes() const {
+    size_t bytes = 0;
+    for (const std::vector<uchar>& level : levels) {
+        bytes += level.size();
+    }
+    return bytes;
+}
@@ -0,0 +1,215 @@
+#include "../include/OccupancySimd.hpp"
+#include <algorithm>
+
+// Mêmes conditions que pour les noyaux du Lidar (voir LidarSimd.cpp) : l'attribut target()
+// permet de compiler les noyaux SSE4 / AVX2 sans les activer pour tout le programme.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define OCCUPANCY_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define OCCUPANCY_SIMD_X86 0
+#endif
+
+// =========================================================
+// NOYAU SCALAIRE (Portable, référence)
+// =========================================================
+
+// État affiché d'une case selon son log-odds (l'obstacle est testé en premier)
+static inline uint8_t stateOf(int value, const LogOddsParams& params) {
+    if (value >= params.occupiedThreshold) return 0;
+    if (value <= params.freeThreshold) return 255;
+    return 127;
+}
+
+// Toujours "inlinée" : les noyaux SSE4 / AVX2 l'utilisent pour leur fin de ligne, qui est ainsi
+// compilée avec le même jeu d'instructions qu'eux (un appel vers du code SSE non-VEX après
+// des instructions AVX coûte une pénalité de transition à chaque appel).
+#if defined(__GNUC__) || defined(__clang__)
+__attribute__((always_inline))
+#endif
+static inline void applyRowScalar(int16_t* logOdds, uint8_t* state, const uint8_t* evidence,
+                                  int count, const LogOddsParams& params, LogOddsRowChanges& changes) {
+    for (int x = 0; x < count; x++) {
+        const uint8_t ev = evidence[x];
+        if (ev == EVIDENCE_NONE) {
+            continue;
+        }
+
+        // Addition puis limitation (les bornes sont dans l'intervalle des int16)
+        int value = logOdds[x] + ((ev == EVIDENCE_HIT) ? params.hit : params.miss);
+        value = std::max<int>(params.minValue, std::min<int>(params.maxValue, value));
+        logOdds[x] = static_cast<int16_t>(value);
+
+        const uint8_t before = state[x];
+        const uint8_t after = stateOf(value, params);
+        if (after != before) {
+            changes.changed++;
+            changes.unknown += (after == 127) - (before == 127);
+            changes.free += (after == 255) - (before == 255);
+            changes.obstacleChanges += (after == 0 || before == 0);
+            state[x] = after;
+        }
+    }
+}
+
+#if OCCUPANCY_SIMD_X86
+// =========================================================
+// NOYAU SSE4 (8 cases à la fois)
+// =========================================================
+
+// Nombre de voies 16 bits à 1 dans un masque de movemask_epi8 (2 bits par voie)
+static inline int laneCount(unsigned mask) {
+    return __builtin_popcount(mask) / 2;
+}
+
+__attribute__((target("sse4.1")))
+static void applyRowSSE4(int16_t* logOdds, uint8_t* state, const uint8_t* evidence,
+                         int count, const LogOddsParams& params, LogOddsRowChanges& changes) {
+    const __m128i hitV = _mm_set1_epi16(params.hit);
+    const __m128i missV = _mm_set1_epi16(params.miss);
+    const __m128i minV = _mm_set1_epi16(params.minValue);
+    const __m128i maxV = _mm_set1_epi16(params.maxValue);
+    const __m128i occupiedV = _mm_set1_epi16(params.occupiedThreshold);
+    const __m128i freeV = _mm_set1_epi16(params.freeThreshold);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i allOnes = _mm_set1_epi16(-1);
+    const __m128i hitCode = _mm_set1_epi16(EVIDENCE_HIT);
+    const __m128i gray = _mm_set1_epi16(127);
+    const __m128i white = _mm_set1_epi16(255);
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        // Évidences (octets) étendues à 16 bits ; les blocs sans évidence sont sautés
+        __m128i ev = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(evidence + x)));
+        __m128i seen = _mm_cmpgt_epi16(ev, zero);
+        if (_mm_testz_si128(seen, seen)) {
+            continue;
+        }
+
+        // Log-odds : addition saturée, limitation, et valeur inchangée pour les cases non vues
+        __m128i delta = _mm_blendv_epi8(missV, hitV, _mm_cmpeq_epi16(ev, hitCode));
+        __m128i before = _mm_loadu_si128(reinterpret_cast<const __m128i*>(logOdds + x));
+        __m128i after = _mm_adds_epi16(before, delta);
+        after = _mm_min_epi16(_mm_max_epi16(after, minV), maxV);
+        after = _mm_blendv_epi8(before, after, seen);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(logOdds + x), after);
+
+        // État affiché : gris par défaut, blanc si <= seuil libre, noir si >= seuil occupé
+        __m128i isFree = _mm_andnot_si128(_mm_cmpgt_epi16(after, freeV), allOnes);
+        __m128i isOccupied = _mm_andnot_si128(_mm_cmpgt_epi16(occupiedV, after), allOnes);
+        __m128i newState = _mm_blendv_epi8(gray, white, isFree);
+        newState = _mm_blendv_epi8(newState, zero, isOccupied);
+
+        __m128i oldState = _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(state + x)));
+        newState = _mm_blendv_epi8(oldState, newState, seen);
+        __m128i changed = _mm_andnot_si128(_mm_cmpeq_epi16(newState, oldState), allOnes);
+        if (_mm_testz_si128(changed, changed)) {
+            continue;
+        }
+
+        // Bilan des changements (comptage des voies par masque)
+        changes.changed += laneCount(_mm_movemask_epi8(changed));
+        changes.unknown += laneCount(_mm_movemask_epi8(_mm_and_si128(changed, _mm_cmpeq_epi16(newState, gray))))
+                         - laneCount(_mm_movemask_epi8(_mm_and_si128(changed, _mm_cmpeq_epi16(oldState, gray))));
+        changes.free += laneCount(_mm_movemask_epi8(_mm_and_si128(changed, _mm_cmpeq_epi16(newState, white))))
+                      - laneCount(_mm_movemask_epi8(_mm_and_si128(changed, _mm_cmpeq_epi16(oldState, white))));
+        changes.obstacleChanges += laneCount(_mm_movemask_epi8(_mm_and_si128(changed,
+            _mm_or_si128(_mm_cmpeq_epi16(newState, zero), _mm_cmpeq_epi16(oldState, zero)))));
+
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(state + x), _mm_packus_epi16(newState, newState));
+    }
+
+    // Fin de ligne (moins de 8 cases)
+    applyRowScalar(logOdds + x, state + x, evidence + x, count - x, params, changes);
+}
+
+// =========================================================
+// NOYAU AVX2 (16 cases à la fois)
+// =========================================================
+__attribute__((target("avx2")))
+static void applyRowAVX2(int16_t* logOdds, uint8_t* state, const uint8_t* evidence,
+                         int count, const LogOddsParams& params, LogOddsRowChanges& changes) {
+    const __m256i hitV = _mm256_set1_epi16(params.hit);
+    const __m256i missV = _mm256_set1_epi16(params.miss);
+    const __m256i minV = _mm256_set1_epi16(params.minValue);
+    const __m256i maxV = _mm256_set1_epi16(params.maxValue);
+    const __m256i occupiedV = _mm256_set1_epi16(params.occupiedThreshold);
+    const __m256i freeV = _mm256_set1_epi16(params.freeThreshold);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i allOnes = _mm256_set1_epi16(-1);
+    const __m256i hitCode = _mm256_set1_epi16(EVIDENCE_HIT);
+    const __m256i gray = _mm256_set1_epi16(127);
+    const __m256i white = _mm256_set1_epi16(255);
+
+    int x = 0;
+    for (; x + 16 <= count; x += 16) {
+        __m256i ev = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(evidence + x)));
+        __m256i seen = _mm256_cmpgt_epi16(ev, zero);
+        if (_mm256_testz_si256(seen, seen)) {
+            continue;
+        }
+
+        __m256i delta = _mm256_blendv_epi8(missV, hitV, _mm256_cmpeq_epi16(ev, hitCode));
+        __m256i before = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(logOdds + x));
+        __m256i after = _mm256_adds_epi16(before, delta);
+        after = _mm256_min_epi16(_mm256_max_epi16(after, minV), maxV);
+        after = _mm256_blendv_epi8(before, after, seen);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(logOdds + x), after);
+
+        __m256i isFree = _mm256_andnot_si256(_mm256_cmpgt_epi16(after, freeV), allOnes);
+        __m256i isOccupied = _mm256_andnot_si256(_mm256_cmpgt_epi16(occupiedV, after), allOnes);
+        __m256i newState = _mm256_blendv_epi8(gray, white, isFree);
+        newState = _mm256_blendv_epi8(newState, zero, isOccupied);
+
+        __m256i oldState = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(state + x)));
+        newState = _mm256_blendv_epi8(oldState, newState, seen);
+        __m256i changed = _mm256_andnot_si256(_mm256_cmpeq_epi16(newState, oldState), allOnes);
+        if (_mm256_testz_si256(changed, changed)) {
+            continue;
+        }
+
+        changes.changed += laneCount(_mm256_movemask_epi8(changed));
+        changes.unknown += laneCount(_mm256_movemask_epi8(_mm256_and_si256(changed, _mm256_cmpeq_epi16(newState, gray))))
+                         - laneCount(_mm256_movemask_epi8(_mm256_and_si256(changed, _mm256_cmpeq_epi16(oldState, gray))));
+        changes.free += laneCount(_mm256_movemask_epi8(_mm256_and_si256(changed, _mm256_cmpeq_epi16(newState, white))))
+                      - laneCount(_mm256_movemask_epi8(_mm256_and_si256(changed, _mm256_cmpeq_epi16(oldState, white))));
+        changes.obstacleChanges += laneCount(_mm256_movemask_epi8(_mm256_and_si256(changed,
+            _mm256_or_si256(_mm256_cmpeq_epi16(newState, zero), _mm256_cmpeq_epi16(oldState, zero)))));
+
+        // Repli 16 bits -> 8 bits (packus travaille par moitié de 128 bits : on assemble les deux moitiés)
+        __m128i packed = _mm_packus_epi16(_mm256_castsi256_si128(newState), _mm256_extracti128_si256(newState, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(state + x), packed);
+    }
+
+    // Fin de ligne (moins de 16 cases)
+    applyRowScalar(logOdds + x, state + x, evidence + x, count - x, params, changes);
+}
+#endif
+
+// =========================================================
+// AIGUILLAGE (Choix du noyau à l'exécution)
+// =========================================================
+void applyLogOddsRow(SimdLevel level, int16_t* logOdds, uint8_t* state, const uint8_t* evidence,
+                     int count, const LogOddsParams& params, LogOddsRowChanges& changes) {
+    if (count <= 0) {
+        return;
+    }
+
+    // On ne dépasse jamais ce que le processeur sait faire
+    SimdLevel supported = detectSimdLevel();
+    if (level > supported) {
+        level = supported;
+    }
+
+#if OCCUPANCY_SIMD_X86
+    if (level == SimdLevel::AVX2) {
+        applyRowAVX2(logOdds, state, evidence, count, params, changes);
+        return;
+    }
+    if (level == SimdLevel::SSE4) {
+        applyRowSSE4(logOdds, state, evidence, count, params, changes);
+        return;
+    }
+#endif
+    applyRowScalar(logOdds, state, evidence, count, params, changes);
+}
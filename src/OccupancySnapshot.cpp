@@ -0,0 +1,145 @@
+#include "../include/OccupancySnapshot.hpp"
+#include <algorithm>
+#include <cstring>
+
+// =========================================================
+// CASES
+// =========================================================
+uchar OccupancySnapshot::getCell(int gx, int gy) const {
+    if (gx < 0 || gx >= gridW || gy < 0 || gy >= gridH) {
+        return 127;
+    }
+    const int tile = (gy >> OccupancyGrid::TILE_SHIFT) * tilesX + (gx >> OccupancyGrid::TILE_SHIFT);
+    if (!tiles[tile]) {
+        return 127; // Tuile absente : inconnue
+    }
+    return tiles[tile]->cells[((gy & OccupancyGrid::TILE_MASK) << OccupancyGrid::TILE_SHIFT) | (gx & OccupancyGrid::TILE_MASK)];
+}
+
+int OccupancySnapshot::getLogOdds(int gx, int gy) const {
+    if (gx < 0 || gx >= gridW || gy < 0 || gy >= gridH) {
+        return 0;
+    }
+    const int tile = (gy >> OccupancyGrid::TILE_SHIFT) * tilesX + (gx >> OccupancyGrid::TILE_SHIFT);
+    if (!tiles[tile] || tiles[tile]->logOdds.empty()) {
+        return 0;
+    }
+    return tiles[tile]->logOdds[((gy & OccupancyGrid::TILE_MASK) << OccupancyGrid::TILE_SHIFT) | (gx & OccupancyGrid::TILE_MASK)];
+}
+
+void OccupancySnapshot::copyRegion(const cv::Rect& cells, cv::Mat& out) const {
+    const cv::Rect region = cells & cv::Rect(0, 0, gridW, gridH);
+    out.create(region.height, region.width, CV_8UC1);
+    const int end = region.x + region.width;
+    for (int y = 0; y < region.height; y++) {
+        const int gy = region.y + y;
+        uchar* row = out.ptr<uchar>(y);
+
+        // Morceau de ligne par tuile traversée (comme OccupancyGrid::copyCells())
+        for (int x = region.x; x < end; ) {
+            const int segmentEnd = std::min(end, ((x >> OccupancyGrid::TILE_SHIFT) + 1) << OccupancyGrid::TILE_SHIFT);
+            const int tile = (gy >> OccupancyGrid::TILE_SHIFT) * tilesX + (x >> OccupancyGrid::TILE_SHIFT);
+            if (tiles[tile]) {
+                const int offset = ((gy & OccupancyGrid::TILE_MASK) << OccupancyGrid::TILE_SHIFT) | (x & OccupancyGrid::TILE_MASK);
+                std::memcpy(row + (x - region.x), tiles[tile]->cells + offset, segmentEnd - x);
+            } else {
+                std::memset(row + (x - region.x), 127, segmentEnd - x);
+            }
+            x = segmentEnd;
+        }
+    }
+}
+
+void OccupancySnapshot::copyTo(cv::Mat& out) const {
+    copyRegion(cv::Rect(0, 0, gridW, gridH), out);
+}
+
+void OccupancySnapshot::draw(cv::Mat& view, const OccupancySnapshot* previous) const {
+    // Première image (ou taille changée) : fond gris puis toutes les tuiles présentes
+    const bool full = !previous || view.rows != height || view.cols != width || view.type() != CV_8UC3;
+    if (full) {
+        view.create(height, width, CV_8UC3);
+        view.setTo(cv::Scalar(127, 127, 127));
+    }
+
+    for (int tile = 0; tile < static_cast<int>(tiles.size()); tile++) {
+        if (!full && sameTile(*previous, tile)) {
+            continue; // Tuile inchangée depuis l'image précédente
+        }
+        const cv::Rect cells = getTileRect(tile);
+        if (tiles[tile]) {
+            OccupancyGrid::renderCells(tiles[tile]->cells, cells, cellSize, view);
+        } else if (!full) {
+            // Tuile devenue absente (grille réinitialisée) : cases inconnues
+            const cv::Rect pixels(cells.x * cellSize, cells.y * cellSize, cells.width * cellSize, cells.height * cellSize);
+            view(pixels & cv::Rect(0, 0, width, height)).setTo(cv::Scalar(127, 127, 127));
+        }
+    }
+}
+
+// =========================================================
+// TUILES (Comparaison de deux instantanés)
+// =========================================================
+int OccupancySnapshot::getTileCount() const {
+    return static_cast<int>(tiles.size());
+}
+
+cv::Rect OccupancySnapshot::getTileRect(int tile) const {
+    const int size = 1 << OccupancyGrid::TILE_SHIFT;
+    const cv::Rect rect((tile % tilesX) * size, (tile / tilesX) * size, size, size);
+    return rect & cv::Rect(0, 0, gridW, gridH);
+}
+
+bool OccupancySnapshot::sameTile(const OccupancySnapshot& other, int tile) const {
+    // La grille ne modifie jamais une tuile gardée par un instantané (elle la copie avant) :
+    // la même tuile dans les deux instantanés a donc le même contenu
+    return tiles[tile] == other.tiles[tile];
+}
+
+// =========================================================
+// GETTERS
+// =========================================================
+uint64_t OccupancySnapshot::getSequence() const {
+    return sequence;
+}
+
+int OccupancySnapshot::getGridWidth() const {
+    return gridW;
+}
+
+int OccupancySnapshot::getGridHeight() const {
+    return gridH;
+}
+
+int OccupancySnapshot::getCellSize() const {
+    return cellSize;
+}
+
+int OccupancySnapshot::getWidth() const {
+    return width;
+}
+
+int OccupancySnapshot::getHeight() const {
+    return height;
+}
+
+OccupancyMode OccupancySnapshot::getMode() const {
+    return mode;
+}
+
+int OccupancySnapshot::getUnknownCount() const {
+    return unknownCount;
+}
+
+int OccupancySnapshot::getFreeCount() const {
+    return freeCount;
+}
+
+int OccupancySnapshot::getOccupiedCount() const {
+    return gridW * gridH - unknownCount - freeCount;
+}
+
+double OccupancySnapshot::getUnknownRatio() const {
+    const int total = gridW * gridH;
+    return (total > 0) ? static_cast<double>(unknownCount) / total : 0.0;
+}
@@ -0,0 +1,271 @@
+#include "../include/PackedTriStateGrid.hpp"
+#include <algorithm>
+#include <cstring>
+
+// SSE2 fait partie du jeu d'instructions de base en x86-64 : pas besoin d'aiguillage à
+// l'exécution (voir LidarSimd.cpp pour les noyaux SSE4 / AVX2)
+#if defined(__SSE2__)
+#define PACKED_GRID_SSE2 1
+#include <emmintrin.h>
+#else
+#define PACKED_GRID_SSE2 0
+#endif
+
+// =========================================================
+// OUTILS SUR LES MOTS DE 64 BITS
+// =========================================================
+
+// Nombre de bits à 1 d'un mot
+static inline int popcount64(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(word);
+#else
+    int count = 0;
+    for (; word != 0; word &= word - 1) {
+        count++;
+    }
+    return count;
+#endif
+}
+
+// Bits (obstacle, libre) de n <= 64 cases consécutives : le bit i correspond à cells[i]
+static inline void cellsToBits(const uchar* cells, int n, uint64_t& occupied, uint64_t& free) {
+    occupied = 0;
+    free = 0;
+    int i = 0;
+#if PACKED_GRID_SSE2
+    // 16 cases à la fois : comparaison octet par octet, puis un bit par octet (movemask)
+    const __m128i black = _mm_setzero_si128();
+    const __m128i white = _mm_set1_epi8(static_cast<char>(255));
+    for (; i + 16 <= n; i += 16) {
+        const __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + i));
+        occupied |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(values, black)))) << i;
+        free |= static_cast<uint64_t>(static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(values, white)))) << i;
+    }
+#endif
+    for (; i < n; i++) {
+        occupied |= static_cast<uint64_t>(cells[i] == 0) << i;
+        free |= static_cast<uint64_t>(cells[i] == 255) << i;
+    }
+}
+
+// Pour chaque octet possible, les 8 octets (dans l'ordre de la mémoire) valant 0xFF là où
+// le bit correspondant est à 1 : calculée une seule fois, indépendante de l'ordre des octets
+struct ByteExpansion {
+    uint64_t bytes[256];
+    ByteExpansion() {
+        for (int value = 0; value < 256; value++) {
+            uchar expanded[8];
+            for (int bit = 0; bit < 8; bit++) {
+                expanded[bit] = ((value >> bit) & 1) ? 255 : 0;
+            }
+            std::memcpy(&bytes[value], expanded, 8);
+        }
+    }
+};
+static const ByteExpansion byteExpansion;
+
+// Valeurs 8 bits (0 / 127 / 255) de n <= 64 cases à partir de leurs bits, 8 cases à la fois
+static inline void bitsToCells(uint64_t occupied, uint64_t free, uchar* cells, int n) {
+    for (int i = 0; i < n; i += 8) {
+        const uint64_t freeBytes = byteExpansion.bytes[(free >> i) & 0xFF];
+        const uint64_t occupiedBytes = byteExpansion.bytes[(occupied >> i) & 0xFF];
+        // Libre : 255 ; inconnu : 127 ; obstacle : 0
+        const uint64_t values = freeBytes | (~(freeBytes | occupiedBytes) & 0x7F7F7F7F7F7F7F7FULL);
+        std::memcpy(cells + i, &values, std::min(8, n - i));
+    }
+}
+
+// Masque des n bits à partir du bit 'shift' (n + shift <= 64)
+static inline uint64_t bitRange(int shift, int n) {
+    return ((n == 64) ? ~0ULL : ((1ULL << n) - 1)) << shift;
+}
+
+// =========================================================
+// CONSTRUCTEUR
+// =========================================================
+PackedTriStateGrid::PackedTriStateGrid(int w, int h) {
+    reset(w, h);
+}
+
+void PackedTriStateGrid::reset(int w, int h) {
+    width = std::max(0, w);
+    height = std::max(0, h);
+    stride = (width + 63) / 64;
+    lastWordMask = (width % 64 == 0) ? ~0ULL : ((1ULL << (width % 64)) - 1);
+
+    // Aucun bit : toutes les cases sont inconnues
+    freeBits.assign(static_cast<size_t>(stride) * height, 0);
+    occupiedBits.assign(static_cast<size_t>(stride) * height, 0);
+}
+
+// =========================================================
+// CONVERSION (8 bits <-> 2 bits)
+// =========================================================
+void PackedTriStateGrid::packRow(int y, int x0, const uchar* cells, int count) {
+    uint64_t* freeRow = &freeBits[static_cast<size_t>(y) * stride];
+    uint64_t* occupiedRow = &occupiedBits[static_cast<size_t>(y) * stride];
+
+    // Un mot à la fois (le premier et le dernier peuvent être partiels)
+    const int end = x0 + count;
+    for (int x = x0; x < end; ) {
+        const int wordEnd = std::min(end, ((x >> 6) + 1) << 6);
+        const int shift = x & 63;
+        const uint64_t mask = bitRange(shift, wordEnd - x);
+
+        uint64_t occupied, free;
+        cellsToBits(cells + (x - x0), wordEnd - x, occupied, free);
+        occupiedRow[x >> 6] = (occupiedRow[x >> 6] & ~mask) | (occupied << shift);
+        freeRow[x >> 6] = (freeRow[x >> 6] & ~mask) | (free << shift);
+        x = wordEnd;
+    }
+}
+
+void PackedTriStateGrid::unpackRow(int y, int x0, uchar* cells, int count) const {
+    const uint64_t* freeRow = &freeBits[static_cast<size_t>(y) * stride];
+    const uint64_t* occupiedRow = &occupiedBits[static_cast<size_t>(y) * stride];
+
+    const int end = x0 + count;
+    for (int x = x0; x < end; ) {
+        const int wordEnd = std::min(end, ((x >> 6) + 1) << 6);
+        const int shift = x & 63;
+        bitsToCells(occupiedRow[x >> 6] >> shift, freeRow[x >> 6] >> shift, cells + (x - x0), wordEnd - x);
+        x = wordEnd;
+    }
+}
+
+void PackedTriStateGrid::pack(const cv::Mat& cells) {
+    reset(cells.cols, cells.rows);
+    for (int y = 0; y < height; y++) {
+        packRow(y, 0, cells.ptr<uchar>(y), width);
+    }
+}
+
+void PackedTriStateGrid::unpack(cv::Mat& cells) const {
+    cells.create(height, width, CV_8UC1);
+    for (int y = 0; y < height; y++) {
+        unpackRow(y, 0, cells.ptr<uchar>(y), width);
+    }
+}
+
+// =========================================================
+// STATISTIQUES (popcount)
+// =========================================================
+int PackedTriStateGrid::countUnknown() const {
+    // Les bits au-delà de la largeur sont toujours à 0 : ni libres ni obstacles
+    return width * height - countFree() - countOccupied();
+}
+
+int PackedTriStateGrid::countFree() const {
+    int count = 0;
+    for (uint64_t word : freeBits) {
+        count += popcount64(word);
+    }
+    return count;
+}
+
+int PackedTriStateGrid::countOccupied() const {
+    int count = 0;
+    for (uint64_t word : occupiedBits) {
+        count += popcount64(word);
+    }
+    return count;
+}
+
+// =========================================================
+// FERMETURE DES OBSTACLES (Morphologie bit à bit)
+// =========================================================
+
+// Une dilatation 3x3 : chaque case devient le OU de son voisinage (rien ne vient de l'extérieur).
+// Passe horizontale (voisins gauche / droite : décalages d'un bit, avec le bit qui passe
+// d'un mot à l'autre), puis passe verticale (OU des lignes voisines).
+static void dilate3x3(std::vector<uint64_t>& bits, std::vector<uint64_t>& rows, int stride, int height, uint64_t lastWordMask) {
+    for (int y = 0; y < height; y++) {
+        const uint64_t* in = &bits[static_cast<size_t>(y) * stride];
+        uint64_t* out = &rows[static_cast<size_t>(y) * stride];
+        for (int k = 0; k < stride; k++) {
+            const uint64_t previous = (k > 0) ? in[k - 1] : 0;
+            const uint64_t next = (k + 1 < stride) ? in[k + 1] : 0;
+            out[k] = in[k] | (in[k] << 1) | (previous >> 63) | (in[k] >> 1) | (next << 63);
+        }
+        out[stride - 1] &= lastWordMask; // Rien au-delà de la largeur
+    }
+    for (int y = 0; y < height; y++) {
+        const uint64_t* above = (y > 0) ? &rows[static_cast<size_t>(y - 1) * stride] : nullptr;
+        const uint64_t* below = (y + 1 < height) ? &rows[static_cast<size_t>(y + 1) * stride] : nullptr;
+        const uint64_t* row = &rows[static_cast<size_t>(y) * stride];
+        uint64_t* out = &bits[static_cast<size_t>(y) * stride];
+        for (int k = 0; k < stride; k++) {
+            out[k] = row[k] | (above ? above[k] : 0) | (below ? below[k] : 0);
+        }
+    }
+}
+
+// Une érosion 3x3 : chaque case devient le ET de son voisinage, l'extérieur comptant comme
+// obstacle (comme la bordure par défaut d'OpenCV : les bords de la grille ne sont pas érodés)
+static void erode3x3(std::vector<uint64_t>& bits, std::vector<uint64_t>& rows, int stride, int height, uint64_t lastWordMask) {
+    for (int y = 0; y < height; y++) {
+        const uint64_t* in = &bits[static_cast<size_t>(y) * stride];
+        uint64_t* out = &rows[static_cast<size_t>(y) * stride];
+        for (int k = 0; k < stride; k++) {
+            // Les bits au-delà de la largeur comptent comme obstacles
+            const uint64_t word = (k + 1 < stride) ? in[k] : (in[k] | ~lastWordMask);
+            const uint64_t previous = (k > 0) ? in[k - 1] : ~0ULL;
+            const uint64_t next = (k + 2 < stride) ? in[k + 1] : (k + 1 < stride) ? (in[k + 1] | ~lastWordMask) : ~0ULL;
+            out[k] = word & ((word << 1) | (previous >> 63)) & ((word >> 1) | (next << 63));
+        }
+    }
+    for (int y = 0; y < height; y++) {
+        const uint64_t* above = (y > 0) ? &rows[static_cast<size_t>(y - 1) * stride] : nullptr;
+        const uint64_t* below = (y + 1 < height) ? &rows[static_cast<size_t>(y + 1) * stride] : nullptr;
+        const uint64_t* row = &rows[static_cast<size_t>(y) * stride];
+        uint64_t* out = &bits[static_cast<size_t>(y) * stride];
+        for (int k = 0; k < stride; k++) {
+            out[k] = row[k] & (above ? above[k] : ~0ULL) & (below ? below[k] : ~0ULL);
+        }
+        out[stride - 1] &= lastWordMask;
+    }
+}
+
+void PackedTriStateGrid::closeObstacles(int iterations, std::vector<uint64_t>& closed) const {
+    closed = occupiedBits;
+    if (stride == 0 || height == 0) {
+        return;
+    }
+
+    // Fermeture = Dilatation(s) suivie(s) d'autant d'Érosion(s)
+    std::vector<uint64_t> rows(closed.size());
+    for (int i = 0; i < iterations; i++) {
+        dilate3x3(closed, rows, stride, height, lastWordMask);
+    }
+    for (int i = 0; i < iterations; i++) {
+        erode3x3(closed, rows, stride, height, lastWordMask);
+    }
+}
+
+// =========================================================
+// GETTERS
+// =========================================================
+int PackedTriStateGrid::getWidth() const {
+    return width;
+}
+
+int PackedTriStateGrid::getHeight() const {
+    return height;
+}
+
+int PackedTriStateGrid::getStride() const {
+    return stride;
+}
+
+const uint64_t* PackedTriStateGrid::getFreeRow(int y) const {
+    return &freeBits[static_cast<size_t>(y) * stride];
+}
+
+const uint64_t* PackedTriStateGrid::getOccupiedRow(int y) const {
+    return &occupiedBits[static_cast<size_t>(y) * stride];
+}
+
+size_t PackedTriStateGrid::getMemoryBytes() const {
+    return (freeBits.size() + occupiedBits.size()) * sizeof(uint64_t);
+}
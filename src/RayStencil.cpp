@@ -0,0 +1,200 @@
+#include "../include/RayStencil.hpp"
+#include "../include/OccupancyGrid.hpp"
+#include <cmath>
+#include <algorithm>
+
+// Définition de PI si non fournie par le compilateur
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+// =========================================================
+// CONSTRUCTEUR
+// =========================================================
+RayStencil::RayStencil()
+    : numRays(0),
+      maxRange(0.0),
+      rotatable(false),
+      lookupRadius(0),
+      currentStamp(0)
+{
+    rayStart.push_back(0);
+}
+
+// =========================================================
+// CONSTRUCTION DE L'ARBRE
+// =========================================================
+void RayStencil::reset(int numRays_, double maxRange_, bool rotatable_) {
+    numRays = numRays_;
+    maxRange = maxRange_;
+    rotatable = rotatable_;
+
+    // Racine : la case du robot, commune à tous les rayons
+    nodeOffset.assign(1, cv::Point(0, 0));
+    nodeChildren.assign(4, -1);
+    nodeCell.assign(1, 0);
+    nodeStamp.assign(1, 0);
+    currentStamp = 0;
+
+    // Numéros des cases distinctes : le DDA n'entre dans aucune case au-delà de la portée,
+    // toutes les cases des rayons sont donc dans un carré de demi-côté portée + 1
+    lookupRadius = static_cast<int>(std::ceil(maxRange)) + 1;
+    const int side = 2 * lookupRadius + 1;
+    cellLookup.assign(static_cast<size_t>(side) * side, -1);
+    cellLookup[static_cast<size_t>(lookupRadius) * side + lookupRadius] = 0;
+    cellStamp.assign(1, 0);
+
+    rayStart.assign(1, 0);
+    rayNodes.clear();
+    rayDist.clear();
+}
+
+// Indice de l'enfant selon le pas du DDA entre deux cases voisines
+static int childSlot(cv::Point from, cv::Point to) {
+    if (to.x > from.x) return 0;
+    if (to.x < from.x) return 1;
+    if (to.y > from.y) return 2;
+    return 3;
+}
+
+// Numéro de la case distincte d'un décalage (un nouveau numéro à la première rencontre)
+int RayStencil::cellIdOf(cv::Point offset) {
+    const int side = 2 * lookupRadius + 1;
+    int& id = cellLookup[static_cast<size_t>(offset.y + lookupRadius) * side + (offset.x + lookupRadius)];
+    if (id < 0) {
+        id = static_cast<int>(cellStamp.size());
+        cellStamp.push_back(0);
+    }
+    return id;
+}
+
+void RayStencil::addRay(const std::vector<cv::Point>& cells, const std::vector<double>& entryDist) {
+    // Le premier nœud est la racine (case du robot) ; on descend dans l'arbre tant que le rayon
+    // suit un chemin déjà connu, puis on crée les nœuds manquants
+    int node = 0;
+    for (size_t k = 0; k < cells.size(); k++) {
+        if (k > 0) {
+            int slot = childSlot(cells[k - 1], cells[k]);
+            int child = nodeChildren[node * 4 + slot];
+            if (child < 0) {
+                child = static_cast<int>(nodeOffset.size());
+                nodeOffset.push_back(cells[k]);
+                nodeCell.push_back(cellIdOf(cells[k]));
+                nodeStamp.push_back(0);
+                nodeChildren.insert(nodeChildren.end(), 4, -1);
+                nodeChildren[node * 4 + slot] = child;
+            }
+            node = child;
+        }
+        rayNodes.push_back(node);
+        rayDist.push_back(entryDist[k]);
+    }
+    rayStart.push_back(static_cast<int>(rayNodes.size()));
+
+    // Les enfants et la table des numéros ne servent qu'à la construction
+    if (isReady()) {
+        std::vector<int>().swap(nodeChildren);
+        std::vector<int>().swap(cellLookup);
+    }
+}
+
+// =========================================================
+// MISE À JOUR DE LA GRILLE
+// =========================================================
+int RayStencil::apply(OccupancyGrid& grid, cv::Point origin, int quarter, const std::vector<double>& ranges) {
+    // Nouveau numéro de scan (après un tour complet du compteur, on efface les anciens)
+    if (++currentStamp == 0) {
+        std::fill(nodeStamp.begin(), nodeStamp.end(), 0u);
+        std::fill(cellStamp.begin(), cellStamp.end(), 0u);
+        currentStamp = 1;
+    }
+
+    const int shift = rotatable ? quarter * (numRays / 4) : 0;
+    int written = 0;
+
+    // Copies locales : les écritures dans la grille (octets) pourraient sinon, pour le
+    // compilateur, modifier ces membres, qui seraient relus à chaque case
+    const unsigned stamp = currentStamp;
+    unsigned* stamps = nodeStamp.data();
+    unsigned* cellStamps = cellStamp.data();
+    const int* cellIds = nodeCell.data();
+    const cv::Point* offsets = nodeOffset.data();
+
+    for (int i = 0; i < numRays; i++) {
+        // Rayon du pochoir ayant la direction du rayon i dans cette orientation
+        int r = i + shift;
+        if (r >= numRays) r -= numRays;
+        const int begin = rayStart[r];
+        const int length = rayStart[r + 1] - begin;
+        const double* dist = &rayDist[begin];
+        const double range = ranges[i];
+
+        // Case du mur : celle dont la distance d'entrée est la distance mesurée
+        // (la plus proche, pour tolérer des distances arrondies)
+        int freeCount = length;
+        if (range < maxRange) {
+            int h = static_cast<int>(std::lower_bound(dist, dist + length, range) - dist);
+            if (h == length || (h > 0 && range - dist[h - 1] < dist[h] - range)) {
+                h--;
+            }
+            freeCount = h;
+            cv::Point cell = origin + offsets[rayNodes[begin + h]];
+            written += grid.markOccupied(cell.x, cell.y);
+        }
+
+        // Cases libres : de la dernière vers le robot, jusqu'à un nœud déjà parcouru par ce scan
+        // (les nœuds précédents sont alors communs avec ce rayon-là, donc déjà parcourus).
+        // Une case atteinte par un autre chemin de l'arbre n'est pas réécrite.
+        // Les nœuds sont lus dans rayNodes et non en remontant les parents : les lectures
+        // sont indépendantes les unes des autres et le processeur peut les anticiper.
+        const int* nodes = &rayNodes[begin];
+        for (int k = freeCount - 1; k >= 0; k--) {
+            const int node = nodes[k];
+            if (stamps[node] == stamp) {
+                break;
+            }
+            stamps[node] = stamp;
+            const int id = cellIds[node];
+            if (cellStamps[id] == stamp) {
+                continue;
+            }
+            cellStamps[id] = stamp;
+            cv::Point cell = origin + offsets[node];
+            written += grid.markFree(cell.x, cell.y);
+        }
+    }
+    return written;
+}
+
+bool RayStencil::quarterOf(double orientation, int& quarter) {
+    double quarters = std::round(orientation / (M_PI / 2.0));
+    quarter = static_cast<int>(((static_cast<long>(quarters) % 4) + 4) % 4);
+    return std::abs(orientation - quarters * (M_PI / 2.0)) < 1e-12;
+}
+
+// =========================================================
+// GETTERS
+// =========================================================
+bool RayStencil::isReady() const {
+    return numRays > 0 && static_cast<int>(rayStart.size()) == numRays + 1;
+}
+
+int RayStencil::getRayCount() const {
+    return numRays;
+}
+
+bool RayStencil::isRotatable() const {
+    return rotatable;
+}
+
+int RayStencil::getNodeCount() const {
+    return static_cast<int>(nodeOffset.size());
+}
+
+int RayStencil::getCellCount() const {
+    return static_cast<int>(cellStamp.size());
+}
+
+int RayStencil::getPathCellCount() const {
+    return static_cast<int>(rayNodes.size());
+}
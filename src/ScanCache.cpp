@@ -0,0 +1,167 @@
+#include "../include/ScanCache.hpp"
+#include <cmath>
+#include <algorithm>
+
+// =========================================================
+// CONSTRUCTEUR
+// =========================================================
+ScanCache::ScanCache(size_t maxBytes_)
+    : numRays(0),
+      maxRange(1.0),
+      rotatable(false),
+      maxBytes(maxBytes_),
+      entryBytes(sizeof(Entry))
+{
+}
+
+// =========================================================
+// CONFIGURATION
+// =========================================================
+void ScanCache::configure(int numRays_, double maxRange_, bool rotatable_) {
+    numRays = numRays_;
+    maxRange = maxRange_;
+    rotatable = rotatable_;
+
+    // Distances + entrée de la liste + case de la table de hachage (estimation)
+    entryBytes = numRays * sizeof(uint16_t) + sizeof(Entry) + sizeof(PoseKey) + 4 * sizeof(void*);
+    clear();
+}
+
+void ScanCache::setMemoryLimit(size_t maxBytes_) {
+    maxBytes = maxBytes_;
+    evict();
+}
+
+void ScanCache::clear() {
+    entries.clear();
+    index.clear();
+    stats.entries = 0;
+    stats.bytes = 0;
+}
+
+void ScanCache::resetStats() {
+    size_t count = entries.size();
+    stats = ScanCacheStats();
+    stats.entries = count;
+    stats.bytes = count * entryBytes;
+}
+
+// =========================================================
+// QUANTIFICATION
+// =========================================================
+uint16_t ScanCache::encode(double range) const {
+    if (range >= maxRange) {
+        return CODE_MAX;
+    }
+    // Une distance sous la portée reste sous la portée (drapeau de contact inchangé)
+    long code = std::lround(range * CODE_MAX / maxRange);
+    return static_cast<uint16_t>(std::max(0L, std::min(static_cast<long>(CODE_MAX) - 1, code)));
+}
+
+double ScanCache::decode(uint16_t code) const {
+    // "Rien touché" rend exactement la portée (pas d'arrondi)
+    return (code == CODE_MAX) ? maxRange : code * maxRange / CODE_MAX;
+}
+
+void ScanCache::quantize(double* ranges) const {
+    for (int i = 0; i < numRays; i++) {
+        ranges[i] = decode(encode(ranges[i]));
+    }
+}
+
+// =========================================================
+// RECHERCHE / AJOUT
+// =========================================================
+ScanCache::PoseKey ScanCache::makeKey(cv::Point position, int quarter, int& shift) const {
+    PoseKey key;
+    key.x = position.x;
+    key.y = position.y;
+    if (rotatable) {
+        // Le rayon i du scan a la direction du rayon i + quarter * numRays/4 de l'orientation 0
+        key.quarter = 0;
+        shift = quarter * (numRays / 4);
+    } else {
+        key.quarter = quarter;
+        shift = 0;
+    }
+    return key;
+}
+
+bool ScanCache::lookup(cv::Point position, int quarter, double* ranges, uint64_t* mappedGrid) {
+    int shift = 0;
+    PoseKey key = makeKey(position, quarter, shift);
+
+    auto found = index.find(key);
+    if (found == index.end()) {
+        stats.misses++;
+        return false;
+    }
+
+    // La pose devient la plus récemment utilisée
+    entries.splice(entries.begin(), entries, found->second);
+    const Entry& entry = entries.front();
+
+    for (int i = 0; i < numRays; i++) {
+        int j = i + shift;
+        if (j >= numRays) j -= numRays;
+        ranges[i] = decode(entry.ranges[j]);
+    }
+
+    if (mappedGrid != nullptr) {
+        *mappedGrid = entry.mappedGrid;
+    }
+    stats.hits++;
+    if (entry.quarter != quarter) {
+        stats.rotatedHits++;
+    }
+    return true;
+}
+
+void ScanCache::insert(cv::Point position, int quarter, double* ranges, uint64_t mappedGrid) {
+    int shift = 0;
+    PoseKey key = makeKey(position, quarter, shift);
+
+    // Pose déjà en cache (insert() sans lookup() préalable) : on remplace son scan
+    auto found = index.find(key);
+    if (found != index.end()) {
+        entries.erase(found->second);
+        index.erase(found);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.quarter = quarter;
+    entry.mappedGrid = mappedGrid;
+    entry.ranges.resize(numRays);
+    for (int i = 0; i < numRays; i++) {
+        int j = i + shift;
+        if (j >= numRays) j -= numRays;
+        entry.ranges[j] = encode(ranges[i]);
+        ranges[i] = decode(entry.ranges[j]);
+    }
+
+    entries.push_front(std::move(entry));
+    index[key] = entries.begin();
+    evict();
+}
+
+void ScanCache::evict() {
+    while (!entries.empty() && entries.size() * entryBytes > maxBytes) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        stats.evictions++;
+    }
+    stats.entries = entries.size();
+    stats.bytes = entries.size() * entryBytes;
+}
+
+// =========================================================
+// GETTERS
+// =========================================================
+bool ScanCache::isEnabled() const {
+    return maxBytes > 0;
+}
+
+ScanCacheStats ScanCache::getStats() const {
+    return stats;
+}
@@ -1,34 +1,123 @@
 #include "../include/Simulation.hpp"
+#include "../include/OccupancySnapshot.hpp"
 #include <iostream>
 #include <random>
-#include <algorithm> // Pour std::max
+#include <algorithm> // Pour std::max et std::stable_sort
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include <atomic>
 
 // =========================================================
 // CONSTRUCTEUR
 // =========================================================
-Simulation::Simulation() 
+Simulation::Simulation(const SimulationOptions& opts) 
     // Liste d'initialisation des membres :
-    : map("map.png"),                           // Charge l'image de la carte
+    : threadPool(opts.threads),                 // Un thread de calcul par cœur (par défaut)
+      // Carte partagée si elle est fournie, sinon chargée depuis l'image
+      map(opts.map ? opts.map : std::make_shared<const Map>(opts.mapPath)),
       robot(cv::Point(0, 0), 11),               // Crée le robot à (0,0) avec une taille de 11px
-      lidar(this),                              // Le Lidar a besoin d'un pointeur vers la Simu pour lire la Map
-      occupancyGrid(map.getWidth(), map.getHeight()), // La grille a la même taille que la map
+      lidar(map.get(), &robot),                 // Le Lidar lit la Map depuis la position du Robot
+      occupancyGrid(map->getWidth(), map->getHeight()), // La grille a la même taille que la map
       behaviorManager(this),                    // Le cerveau a besoin d'accéder aux capteurs via la Simu
-      arucoManager(&behaviorManager),           // Le gestionnaire ArUco pilote le BehaviorManager
-      windowName("Dashboard Robot")             // Titre de la fenêtre
+      arucoManager(&behaviorManager, !opts.headless), // Pilote le BehaviorManager (pas de caméra sans affichage)
+      options(opts),                            // Options de lancement
+      nextEvent(0),                             // Aucun événement scripté appliqué
+      tick(0),                                  // Premier tick
+      exploredTick(-1),                         // Pas encore explorée
+      pathLength(0.0),                          // Aucun déplacement
+      seed(0),                                  // Graine choisie dans le corps du constructeur
+      trajectoryHash(14695981039346656037ull),  // Base FNV-1a 64 bits
+      nextExpectedMode(0),
+      divergenceTick(-1),
+      replayIdentical(false),
+      windowName("Dashboard Robot"),            // Titre de la fenêtre
+      frameAllocations(0),
+      totalFrameAllocations(0),
+      renderedFrames(0),
+      seenCameraAllocations(0)
 {
+    // Le Lidar répartit ses rayons sur les threads persistants (s'il y en a assez)
+    lidar.setThreadPool(&threadPool);
+
+    // La carte est statique et le suivi de mur repasse souvent par les mêmes couloirs :
+    // les scans déjà calculés sont réutilisés (16 Mo, environ 20 000 poses de 360 rayons)
+    lidar.setScanCacheLimit(16 * 1024 * 1024);
+
+    // Rejeu : la session enregistrée remplace graine, pas de temps, entrées et durée
+    if (options.replay) {
+        const InputLogReader& replay = *options.replay;
+        options.seed = replay.getSeed();
+        options.timestepMs = replay.getTimestepMs();
+        options.maxTicks = replay.getTickCount();
+        options.untilExplored = false;
+        options.events.clear();
+        for (const InputRecord& record : replay.getRecords()) {
+            if (record.key >= 0 || record.arucoId >= 0) {
+                options.events.push_back({ record.tick, record.key, record.arucoId });
+            }
+            if (record.modeChanged) {
+                expectedModes.push_back(record);
+            }
+        }
+    }
+
+    // Graine de la position de départ : tirée au hasard si les options n'en donnent pas
+    // (elle est affichée et enregistrée pour pouvoir rejouer la session)
+    std::random_device rd;
+    seed = options.seed;
+    while (seed == 0) {
+        seed = rd();
+    }
+
+    // Les événements scriptés sont consommés dans l'ordre des ticks
+    // (tri stable : deux événements du même tick gardent leur ordre)
+    std::stable_sort(options.events.begin(), options.events.end(),
+                     [](const ScriptedEvent& a, const ScriptedEvent& b) { return a.tick < b.tick; });
+
+    behaviorManager.setVerbose(options.verbose);
+
     // Crée une fenêtre OpenCV redimensionnable
-    cv::namedWindow(windowName, cv::WINDOW_AUTOSIZE);
+    if (!options.headless) {
+        cv::namedWindow(windowName, cv::WINDOW_AUTOSIZE);
+    }
     
     // Trouve une position aléatoire valide pour le robot (hors des murs)
     initializeRobotPosition();
+    recordStats(); // Position de départ dans l'empreinte de la trajectoire (tick 0)
+
+    // Le journal note le fichier d'où la carte a vraiment été chargée (options.mapPath est ignoré
+    // quand une carte partagée est fournie) ; une carte construite en mémoire ne peut pas être rejouée
+    if (!options.recordPath.empty()) {
+        if (map->getPath().empty()) {
+            std::cerr << "ERREUR : La carte n'a pas ete chargee depuis un fichier, la session ne sera pas enregistree."
+                      << std::endl;
+        } else {
+            recorder.open(options.recordPath, seed, map->getPath(), options.timestepMs);
+        }
+    }
+    if (!options.gridLogPath.empty()) {
+        gridLog.open(options.gridLogPath, options.gridLogKeyframeInterval);
+    }
     
     // Affichage des instructions dans la console au démarrage
+    if (!options.verbose) {
+        return;
+    }
     std::cout << "\n=== SIMULATION DEMARREE ===" << std::endl;
-    std::cout << "Controles:" << std::endl;
-    std::cout << "  - Touche 1: Mode MANUEL (ZQSD)" << std::endl;
-    std::cout << "  - Touche 2: Mode WALL FOLLOWING" << std::endl;
-    std::cout << "  - ZQSD: Deplacements en mode MANUEL" << std::endl;
-    std::cout << "  - ESC: Quitter" << std::endl;
+    std::cout << "Graine : " << seed << (options.replay ? " (rejeu)" : "") << std::endl;
+    if (options.headless) {
+        std::cout << "Mode sans affichage : pas de " << options.timestepMs << " ms";
+        if (options.maxTicks > 0) std::cout << ", " << options.maxTicks << " ticks max";
+        if (options.untilExplored) std::cout << ", arret a la fin de l'exploration";
+        std::cout << ", " << options.events.size() << " evenement(s) scripte(s)" << std::endl;
+    } else {
+        std::cout << "Controles:" << std::endl;
+        std::cout << "  - Touche 1: Mode MANUEL (ZQSD)" << std::endl;
+        std::cout << "  - Touche 2: Mode WALL FOLLOWING" << std::endl;
+        std::cout << "  - ZQSD: Deplacements en mode MANUEL" << std::endl;
+        std::cout << "  - ESC: Quitter" << std::endl;
+    }
     std::cout << "================================\n" << std::endl;
 }
 
@@ -36,117 +125,417 @@ Simulation::Simulation()
 // MÉTHODE PRINCIPALE : RUN
 // =========================================================
 void Simulation::run() {
-    bool running = true;    // Variable de contrôle de la boucle principale
-    int frameCounter = 0;   // Compteur de frames pour gérer des événements périodiques
+    auto startTime = std::chrono::steady_clock::now();
 
-    // Boucle infinie jusqu'à demande d'arrêt
-    while (running) {
-        
-        // 1. VISION : Capture webcam et détection des tags ArUco
-        // Cela met à jour le comportement du robot si un tag est vu
-        arucoManager.captureAndDetect();
+    // Scan initial depuis la position de départ : le comportement du premier tick
+    // en a besoin avant que le robot ait bougé
+    lidar.scan(scan);
 
-        // 2. INPUTS : Gestion des entrées clavier
-        // cv::waitKey(30) attend 30ms, ce qui limite la boucle à ~30 FPS
-        int key = cv::waitKey(30);
-        
-        // Si la touche Echap (ASCII 27) est pressée, on quitte la boucle
-        if (key == 27) { running = false; continue; }
-        
-        // Raccourcis clavier pour forcer les modes sans ArUco (Debug)
-        if (key == '1') behaviorManager.setByArucoId(0);      // Force mode Manuel
-        else if (key == '2') behaviorManager.setByArucoId(1); // Force mode Suivi Mur
-
-        // Variables pour stocker le déplacement demandé par le cerveau
-        int dx = 0, dy = 0;
-
-        // 3. INTELLIGENCE : Exécution du comportement actuel
-        // Le BehaviorManager décide de dx/dy en fonction du mode et des capteurs
-        behaviorManager.execute(dx, dy, key);
-
-        // 4. PHYSIQUE : Application du mouvement
-        // On ne tente de bouger que si un déplacement est demandé
-        if (dx != 0 || dy != 0) {
-            // Calcul de la future position théorique
-            cv::Point currentPos = robot.getPosition();
-            cv::Point futurePos = currentPos + cv::Point(dx, dy);
-
-            // Vérification des collisions avant d'appliquer le mouvement
-            if (!checkCollision(futurePos)) {
-                robot.setPosition(futurePos);      // Applique la nouvelle position
-                robot.updateOrientation(dx, dy);   // Met à jour l'angle du robot (visuel + lidar)
+    // Sans affichage : tous les ticks à la suite, sur ce thread.
+    // Avec affichage : simulation et affichage sur deux threads (voir runWindowed())
+    if (options.headless) {
+        while (!shouldStop() && runTick(-1, -1)) {
+        }
+    } else {
+        runWindowed();
+    }
+
+    finishSession();
+
+    // Bilan (temps simulé : un pas fixe par tick)
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (options.verbose) {
+        std::cout << "Fin de la simulation : " << tick << " ticks (" << tick * options.timestepMs / 1000.0
+                  << " s simulees) en " << wallSeconds << " s";
+        if (wallSeconds > 0.0) std::cout << " (" << static_cast<int>(tick / wallSeconds) << " ticks/s)";
+        std::cout << ", " << occupancyGrid.getUnknownCount() << " cases inconnues" << std::endl;
+    }
+    
+    if (!options.headless && options.verbose) {
+        std::cout << "Images : " << frames.getPublishedCount() << " publiees, " << frames.getDroppedCount()
+                  << " abandonnees (affichage en retard sur la simulation)" << std::endl;
+        std::cout << "Tableau de bord : " << renderedFrames << " images affichees, " << totalFrameAllocations
+                  << " allocations d'images (derniere image : " << frameAllocations << ")" << std::endl;
+    }
+}
+
+// =========================================================
+// AFFICHAGE : THREAD DE SIMULATION + THREAD D'AFFICHAGE
+// =========================================================
+void Simulation::runWindowed() {
+    // Entrées lues par l'affichage, consommées par la simulation au tick suivant
+    // (-1 : rien en attente)
+    std::atomic<int> pendingKey(-1);
+    std::atomic<int> pendingMarker(-1);
+    std::atomic<bool> simulationDone(false);
+
+    // Image de départ, avant le premier tick
+    publishFrame();
+
+    // 1 à 6. THREAD DE SIMULATION : un tick tous les timestepMs, quel que soit le coût de l'affichage
+    std::thread simulationThread([&]() {
+        const std::chrono::milliseconds timestep(options.timestepMs);
+        auto nextTick = std::chrono::steady_clock::now();
+        while (!shouldStop()) {
+            if (!runTick(pendingKey.exchange(-1), pendingMarker.exchange(-1))) {
+                break; // ESC
+            }
+            publishFrame();
+
+            // Pas fixe : si un tick a pris trop de temps, on repart de maintenant (pas de rattrapage)
+            nextTick += timestep;
+            auto now = std::chrono::steady_clock::now();
+            if (nextTick < now) {
+                nextTick = now;
             }
+            std::this_thread::sleep_until(nextTick);
         }
+        simulationDone = true;
+    });
 
-        // 5. CAPTEURS : Mise à jour du Lidar et de la Carte Mémoire
-        // Le Lidar lance ses rayons depuis la nouvelle position du robot
-        std::vector<cv::Point> hits = lidar.getHitPoints(robot);
-        
-        // On met à jour la grille d'occupation avec les points d'impact
-        occupancyGrid.update(hits, robot.getPosition());
-        
-        // 6. POST-TRAITEMENT : Nettoyage de la carte (Optionnel)
-        frameCounter++;
-        // Toutes les 60 frames (environ 2 sec), on lisse un peu la grille
-        if (frameCounter % 60 == 0) {
-            occupancyGrid.smoothGrid(1);
+    // 7. THREAD D'AFFICHAGE (thread principal : HighGUI et la caméra y restent)
+    // Il dessine la dernière image complète publiée ; les images publiées entre deux
+    // affichages sont abandonnées.
+    while (!simulationDone) {
+        // Vision : capture webcam et détection des tags ArUco (HUD avec le mode de la dernière image)
+        arucoManager.captureAndDetect(frames.getReadBuffer().behaviorName);
+        if (arucoManager.getDetectedId() >= 0) {
+            pendingMarker = arucoManager.getDetectedId();
         }
 
-        // 7. RENDU GRAPHIQUE (Dashboard)
-        
-        // A. Préparation de la vue "Simulation" (Vérité terrain)
-        cv::Mat simFrame = map.getImage().clone(); // Copie de la carte originale
-        lidar.draw(simFrame, robot);               // Dessin des rayons rouges
-        robot.draw(simFrame);                      // Dessin du robot
-
-        // B. Préparation de la vue "Mémoire" (Ce que le robot voit)
-        cv::Mat memFrame;
-        occupancyGrid.draw(memFrame);              // Conversion de la grille en image
-        robot.draw(memFrame);                      // Dessin du robot pour se repérer
-
-        // C. Récupération de la vue "Caméra" (Webcam avec réalité augmentée)
-        cv::Mat camFrame = arucoManager.getFrame();
-
-        // D. Calcul des dimensions du tableau de bord global
-        // Largeur totale = max(largeur simu + largeur map, largeur caméra)
-        int topRowWidth = simFrame.cols + memFrame.cols;
-        int totalWidth = std::max(topRowWidth, camFrame.cols);
-        // Hauteur totale = hauteur des cartes + hauteur caméra + marge
-        int totalHeight = std::max(simFrame.rows, memFrame.rows) + camFrame.rows + 10;
-
-        // Création de l'image vide du tableau de bord (fond gris foncé)
-        cv::Mat dashboard = cv::Mat(totalHeight, totalWidth, CV_8UC3, cv::Scalar(40, 40, 40));
-
-        // Copie des images dans le tableau de bord
-        // 1. Simulation en haut à gauche
-        simFrame.copyTo(dashboard(cv::Rect(0, 0, simFrame.cols, simFrame.rows)));
-        
-        // 2. Occupancy Grid en haut à droite
-        memFrame.copyTo(dashboard(cv::Rect(simFrame.cols, 0, memFrame.cols, memFrame.rows)));
-        
-        // 3. Caméra centrée en bas
-        int camX = (totalWidth - camFrame.cols) / 2; // Calcul pour centrer
-        if (camX < 0) camX = 0; // Sécurité
-        int camY = std::max(simFrame.rows, memFrame.rows) + 10; // Juste en dessous des cartes
-        
-        // Copie de l'image caméra
-        camFrame.copyTo(dashboard(cv::Rect(camX, camY, camFrame.cols, camFrame.rows)));
+        // Clavier : cv::waitKey traite aussi les événements de la fenêtre.
+        // ESC n'est jamais écrasé par une touche suivante avant d'être lu.
+        int key = cv::waitKey(1);
+        if (key >= 0 && pendingKey != 27) {
+            pendingKey = key;
+        }
 
-        // Affichage final de l'image composée
-        cv::imshow(windowName, dashboard);
+        if (frames.update()) {
+            renderDashboard(frames.getReadBuffer());
+        }
     }
-    
+    simulationThread.join();
+
     // Nettoyage à la fin du programme
     cv::destroyAllWindows();
 }
 
+void Simulation::publishFrame() {
+    // Copie de l'état du tick dans l'emplacement libre (les vecteurs du scan gardent leur capacité)
+    FrameState& frame = frames.getWriteBuffer();
+    frame.tick = tick;
+    frame.robot = robot;
+    frame.scan = scan;
+    frame.grid = occupancyGrid.publishSnapshot();
+    frame.behaviorName = behaviorManager.getBehaviorName();
+    frames.publish();
+}
+
+// =========================================================
+// ÉTAPES D'UN TICK
+// =========================================================
+
+bool Simulation::runTick(int key, int markerId) {
+    const int tickIndex = tick;
+    const Behavior before = behaviorManager.getCurrentBehavior();
+
+    // 1. VISION : tag ArUco vu par la caméra (thread d'affichage) depuis le tick précédent
+    if (markerId >= 0) {
+        arucoManager.injectMarker(markerId);
+        recordInput(-1, markerId);
+    }
+
+    // 2. INPUTS : entrées scriptées (remplacent la touche de ce tick, ou l'absence de touche)
+    applyScriptedEvents(key);
+    recordInput(key, -1);
+
+    // Si la touche Echap (ASCII 27) est pressée, on quitte la boucle
+    if (key == 27) {
+        return false;
+    }
+
+    // 3 à 6. Un tick de simulation
+    step(key);
+    checkModeChange(tickIndex, before);
+    return true;
+}
+
+// Applique les événements scriptés dont le tick est arrivé
+void Simulation::applyScriptedEvents(int& key) {
+    while (nextEvent < options.events.size() && options.events[nextEvent].tick <= tick) {
+        const ScriptedEvent& event = options.events[nextEvent++];
+        if (event.arucoId >= 0) {
+            arucoManager.injectMarker(event.arucoId); // Comme un tag vu
+            recordInput(-1, event.arucoId);
+        }
+        if (event.key >= 0) key = event.key;                              // Comme une touche
+    }
+}
+
+void Simulation::step(int key) {
+    // Raccourcis clavier pour forcer les modes sans ArUco (Debug)
+    if (key == '1') behaviorManager.setByArucoId(0);      // Force mode Manuel
+    else if (key == '2') behaviorManager.setByArucoId(1); // Force mode Suivi Mur
+
+    // Variables pour stocker le déplacement demandé par le cerveau
+    int dx = 0, dy = 0;
+
+    // 3. INTELLIGENCE : Exécution du comportement actuel
+    // Le BehaviorManager décide de dx/dy en fonction du mode et du scan courant
+    // (celui du tick précédent, pris depuis la position actuelle du robot)
+    behaviorManager.execute(dx, dy, key, scan);
+
+    // 4. PHYSIQUE : Application du mouvement
+    // On ne tente de bouger que si un déplacement est demandé
+    if (dx != 0 || dy != 0) {
+        // Calcul de la future position théorique
+        cv::Point currentPos = robot.getPosition();
+        cv::Point futurePos = currentPos + cv::Point(dx, dy);
+
+        // Vérification des collisions avant d'appliquer le mouvement
+        if (!checkCollision(futurePos)) {
+            robot.setPosition(futurePos);      // Applique la nouvelle position
+            robot.updateOrientation(dx, dy);   // Met à jour l'angle du robot (visuel + lidar)
+            pathLength += std::sqrt(static_cast<double>(dx * dx + dy * dy));
+        }
+    }
+
+    // 5. CAPTEURS : Mise à jour du Lidar et de la Carte Mémoire
+    // Le Lidar lance ses rayons UNE SEULE FOIS par tick, depuis la nouvelle position,
+    // et marque la grille d'occupation pendant ce même parcours (cases libres + murs).
+    // Ce même scan sert à l'affichage et au comportement du tick suivant.
+    lidar.scanAndMap(scan, occupancyGrid);
+    
+    // 6. POST-TRAITEMENT : Nettoyage de la carte (Optionnel)
+    tick++;
+    // Toutes les 60 ticks (environ 2 sec), on lisse un peu la grille
+    if (tick % 60 == 0) {
+        occupancyGrid.smoothGrid(1);
+    }
+
+    // 7. ARCHIVE : état de la grille après ce tick (seules les cases changées sont écrites)
+    if (gridLog.isOpen()) {
+        gridLog.writeTick(occupancyGrid);
+    }
+
+    recordStats();
+}
+
+void Simulation::layoutDashboard(const cv::Size& gridSize, const cv::Size& camSize) {
+    const cv::Size simSize = map->getImage().size();
+
+    // Largeur totale = max(largeur simu + largeur map, largeur caméra)
+    int totalWidth = std::max(simSize.width + gridSize.width, camSize.width);
+    // Hauteur totale = hauteur des cartes + hauteur caméra + marge
+    int topRowHeight = std::max(simSize.height, gridSize.height);
+    int totalHeight = topRowHeight + camSize.height + 10;
+
+    // Image du tableau de bord (fond gris foncé), gardée tant que la disposition ne change pas
+    const uchar* before = dashboard.data;
+    dashboard.create(totalHeight, totalWidth, CV_8UC3);
+    if (dashboard.data != before) {
+        frameAllocations++;
+    }
+    dashboard.setTo(cv::Scalar(40, 40, 40));
+
+    // Zones de chaque vue (partagent les pixels du tableau de bord)
+    // 1. Simulation en haut à gauche
+    simView = dashboard(cv::Rect(0, 0, simSize.width, simSize.height));
+    // 2. Occupancy Grid en haut à droite
+    memView = dashboard(cv::Rect(simSize.width, 0, gridSize.width, gridSize.height));
+    // 3. Caméra centrée en bas, juste en dessous des cartes
+    int camX = (totalWidth - camSize.width) / 2;
+    camView = dashboard(cv::Rect(camX, topRowHeight + 10, camSize.width, camSize.height));
+
+    // La caméra écrit désormais ses images directement dans sa zone
+    arucoManager.setFrameBuffer(camView);
+
+    // La vue "Mémoire" est à redessiner entièrement (plus de robot à effacer)
+    drawnGrid.reset();
+    robotPatchRect = cv::Rect();
+}
+
+void Simulation::renderDashboard(FrameState& frame) {
+    frameAllocations = 0;
+
+    // Nouvelle disposition à la première image, ou si la grille ou la caméra changent de taille
+    const cv::Size gridSize(frame.grid->getWidth(), frame.grid->getHeight());
+    if (dashboard.empty() || memView.size() != gridSize || camView.size() != arucoManager.getFrame().size()) {
+        layoutDashboard(gridSize, arucoManager.getFrame().size());
+    }
+
+    // Chaque vue est dessinée sur place dans sa zone du tableau de bord (pas d'image intermédiaire)
+
+    // A. Vue "Simulation" (Vérité terrain)
+    map->getImage().copyTo(simView);            // Carte originale (efface les rayons précédents)
+    lidar.draw(simView, frame.scan);            // Dessin des rayons rouges (scan du tick)
+    frame.robot.draw(simView);                  // Dessin du robot
+
+    // B. Vue "Mémoire" (Ce que le robot voit)
+    // Le robot de l'image précédente est d'abord effacé (pixels de la grille sauvegardés sous lui)
+    if (robotPatchRect.area() > 0) {
+        robotPatch.copyTo(memView(robotPatchRect));
+    }
+    // L'instantané de la grille ne redessine que les tuiles changées depuis l'image précédente
+    // (gardée en vie dans drawnGrid : ses tuiles n'ont pas pu être modifiées depuis)
+    frame.grid->draw(memView, drawnGrid.get());
+    drawnGrid = frame.grid;
+    // Sauvegarde des pixels sous le robot, puis dessin du robot pour se repérer
+    const cv::Point position = frame.robot.getPosition();
+    const int margin = frame.robot.getSize();
+    robotPatchRect = cv::Rect(position.x - margin, position.y - margin, 2 * margin + 1, 2 * margin + 1) &
+                     cv::Rect(0, 0, memView.cols, memView.rows);
+    const uchar* before = robotPatch.data;
+    memView(robotPatchRect).copyTo(robotPatch);
+    if (robotPatch.data != before) {
+        frameAllocations++;
+    }
+    frame.robot.draw(memView);
+
+    // C. Vue "Caméra" (Webcam avec réalité augmentée) : déjà écrite dans sa zone par
+    // captureAndDetect(). Ses allocations depuis l'image précédente comptent pour celle-ci.
+    const uint64_t cameraAllocations = arucoManager.getAllocationCount();
+    frameAllocations += static_cast<int>(cameraAllocations - seenCameraAllocations);
+    seenCameraAllocations = cameraAllocations;
+
+    renderedFrames++;
+    totalFrameAllocations += frameAllocations;
+
+    // Affichage final de l'image composée
+    cv::imshow(windowName, dashboard);
+}
+
+bool Simulation::shouldStop() const {
+    if (options.maxTicks > 0 && tick >= options.maxTicks) {
+        return true;
+    }
+    // Temps constant : la grille tient à jour son nombre de cases inconnues
+    return options.untilExplored && occupancyGrid.isFullyExplored();
+}
+
+// Ajoute des octets à une empreinte FNV-1a 64 bits
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+void Simulation::recordStats() {
+    // Pose du robot après le tick (bit à bit : la moindre différence change l'empreinte)
+    const cv::Point pos = robot.getPosition();
+    const double orientation = robot.getOrientation();
+    trajectoryHash = hashBytes(trajectoryHash, &pos.x, sizeof(pos.x));
+    trajectoryHash = hashBytes(trajectoryHash, &pos.y, sizeof(pos.y));
+    trajectoryHash = hashBytes(trajectoryHash, &orientation, sizeof(orientation));
+
+    if (exploredTick < 0 && occupancyGrid.isFullyExplored()) {
+        exploredTick = tick;
+    }
+    if (options.coverageInterval > 0 && tick % options.coverageInterval == 0) {
+        coverageCurve.push_back(1.0 - occupancyGrid.getUnknownRatio());
+    }
+}
+
+// =========================================================
+// ENREGISTREMENT ET REJEU
+// =========================================================
+void Simulation::recordInput(int key, int arucoId) {
+    if (recorder.isOpen() && (key >= 0 || arucoId >= 0)) {
+        recorder.write({ tick, key, arucoId, false, Behavior::IDLE });
+    }
+}
+
+void Simulation::checkModeChange(int tickIndex, Behavior before) {
+    const Behavior after = behaviorManager.getCurrentBehavior();
+    const bool changed = (after != before);
+    if (changed && recorder.isOpen()) {
+        recorder.write({ tickIndex, -1, -1, true, after });
+    }
+    if (!options.replay || divergenceTick >= 0) {
+        return;
+    }
+
+    // Le changement de mode (ou son absence) doit être celui de l'enregistrement
+    const bool expected = nextExpectedMode < expectedModes.size() &&
+                          expectedModes[nextExpectedMode].tick == tickIndex;
+    if (changed != expected || (changed && expectedModes[nextExpectedMode].behavior != after)) {
+        divergenceTick = tickIndex;
+    }
+    if (expected) {
+        nextExpectedMode++;
+    }
+}
+
+void Simulation::finishSession() {
+    if (gridLog.isOpen()) {
+        gridLog.close();
+        if (options.verbose) {
+            std::cout << "Grille archivee dans " << options.gridLogPath << " (" << gridLog.getTickCount()
+                      << " ticks, " << gridLog.getBytesWritten() << " octets)" << std::endl;
+        }
+    }
+    if (!recorder.isOpen() && !options.replay) {
+        return;
+    }
+    const uint64_t gridHash = computeGridHash();
+    if (recorder.isOpen()) {
+        recorder.finish(tick, trajectoryHash, gridHash);
+        if (options.verbose) {
+            std::cout << "Session enregistree dans " << options.recordPath << " (" << recorder.getBytesWritten()
+                      << " octets)" << std::endl;
+        }
+    }
+    if (!options.replay) {
+        return;
+    }
+
+    const InputLogReader& replay = *options.replay;
+    replayIdentical = (divergenceTick < 0 && nextExpectedMode == expectedModes.size());
+    if (replay.isComplete()) {
+        replayIdentical = replayIdentical && tick == replay.getTickCount() &&
+                          trajectoryHash == replay.getTrajectoryHash() && gridHash == replay.getGridHash();
+    }
+
+    if (!replayIdentical) {
+        std::cerr << "ERREUR : Le rejeu differe de l'enregistrement";
+        if (divergenceTick >= 0) std::cerr << " (changement de mode different au tick " << divergenceTick << ")";
+        else if (nextExpectedMode < expectedModes.size()) std::cerr << " (changements de mode manquants)";
+        else if (tick != replay.getTickCount()) std::cerr << " (" << tick << " ticks au lieu de " << replay.getTickCount() << ")";
+        else if (trajectoryHash != replay.getTrajectoryHash()) std::cerr << " (trajectoire)";
+        else std::cerr << " (grille)";
+        std::cerr << "." << std::endl;
+    } else if (options.verbose) {
+        std::cout << "Rejeu identique a l'enregistrement (" << tick << " ticks"
+                  << (replay.isComplete() ? "" : ", journal incomplet : empreintes non verifiees") << ")" << std::endl;
+    }
+}
+
+uint64_t Simulation::computeGridHash() {
+    // Lecture par un instantané (tuiles partagées, aucune copie de la grille)
+    std::shared_ptr<const OccupancySnapshot> snapshot = occupancyGrid.publishSnapshot();
+    const bool logOdds = (snapshot->getMode() == OccupancyMode::LOG_ODDS);
+    uint64_t hash = 14695981039346656037ull;
+    cv::Mat cells;
+    snapshot->copyTo(cells);
+    for (int gy = 0; gy < cells.rows; gy++) {
+        hash = hashBytes(hash, cells.ptr<uchar>(gy), static_cast<size_t>(cells.cols));
+        for (int gx = 0; logOdds && gx < cells.cols; gx++) {
+            const int value = snapshot->getLogOdds(gx, gy);
+            hash = hashBytes(hash, &value, sizeof(value));
+        }
+    }
+    return hash;
+}
+
 // =========================================================
 // GETTERS 
 // =========================================================
 
 // Retourne une référence constante vers la carte
 const Map& Simulation::getMap() const { 
-    return map; 
+    return *map; 
 }
 
 // Retourne une référence constante vers le robot 
@@ -170,17 +559,57 @@ Robot& Simulation::getRobotMutable() {
     return robot; 
 }
 
+int Simulation::getTickCount() const {
+    return tick;
+}
+
+int Simulation::getExploredTick() const {
+    return exploredTick;
+}
+
+double Simulation::getPathLength() const {
+    return pathLength;
+}
+
+const std::vector<double>& Simulation::getCoverageCurve() const {
+    return coverageCurve;
+}
+
+unsigned Simulation::getSeed() const {
+    return seed;
+}
+
+uint64_t Simulation::getTrajectoryHash() const {
+    return trajectoryHash;
+}
+
+bool Simulation::isReplayIdentical() const {
+    return replayIdentical;
+}
+
+int Simulation::getLastFrameAllocations() const {
+    return frameAllocations;
+}
+
+uint64_t Simulation::getFrameAllocationCount() const {
+    return totalFrameAllocations;
+}
+
+uint64_t Simulation::getRenderedFrameCount() const {
+    return renderedFrames;
+}
+
 // =========================================================
 // MÉTHODES PRIVÉES 
 // =========================================================
 
 // Initialise la position du robot aléatoirement mais hors des murs
 void Simulation::initializeRobotPosition() {
-    std::random_device rd;  // Source d'entropie matérielle
-    std::mt19937 gen(rd()); // Générateur Mersenne Twister
+    // Générateur Mersenne Twister (même graine : même position de départ)
+    std::mt19937 gen(seed);
 
-    int width = map.getWidth();
-    int height = map.getHeight();
+    int width = map->getWidth();
+    int height = map->getHeight();
     int margin = robot.getSize(); // Marge pour ne pas spawner dans un mur bordure
 
     // Distributions uniformes pour X et Y
@@ -201,7 +630,7 @@ void Simulation::initializeRobotPosition() {
             // Si c'est libre, on valide et on place le robot
             robot.setPosition(candidatePos);
             validPositionFound = true;
-            std::cout << "Robot init: [" << candidatePos.x << ", " << candidatePos.y << "]" << std::endl;
+            if (options.verbose) std::cout << "Robot init: [" << candidatePos.x << ", " << candidatePos.y << "]" << std::endl;
         }
     }
 
@@ -217,19 +646,10 @@ bool Simulation::checkCollision(cv::Point centerPos) const {
     int hit_radius = robot.getSize() / 2; // Rayon du robot
     int r2 = hit_radius * hit_radius;     // Rayon au carré (pour éviter les racines carrées)
 
-    // On parcourt un carré autour du centre du robot (Bounding Box)
-    for (int y = -hit_radius; y <= hit_radius; ++y) {
-        for (int x = -hit_radius; x <= hit_radius; ++x) {
-            
-            // On ne vérifie que les pixels qui sont DANS le cercle du robot
-            // Équation du cercle : x^2 + y^2 <= r^2
-            if (x*x + y*y <= r2) {
-                // Si le pixel correspondant sur la carte est un obstacle
-                if (map.isObstacle(centerPos.x + x, centerPos.y + y)) {
-                    return true; // Collision détectée
-                }
-            }
-        }
-    }
-    return false; // Aucune collision trouvée
+    // Le champ de distance de la Map donne directement la distance entre le centre du robot
+    // et le centre du mur le plus proche : il y a collision si ce mur est DANS le cercle
+    // du robot (x^2 + y^2 <= r^2), exactement comme si on testait chaque pixel du disque.
+    // Les distances au carré sont des entiers : la marge de 0.5 absorbe l'arrondi flottant.
+    float clearance = map->getClearance(centerPos.x, centerPos.y);
+    return clearance * clearance <= r2 + 0.5f;
 }
\ No newline at end of file
@@ -0,0 +1,128 @@
+#include "../include/ThreadPool.hpp"
+#include <algorithm>
+
+// =========================================================
+// CONSTRUCTEUR / DESTRUCTEUR
+// =========================================================
+ThreadPool::ThreadPool(int numThreads)
+    : job(nullptr),
+      jobCount(0),
+      jobChunk(1),
+      numChunks(0),
+      nextChunk(0),
+      generation(0),
+      busyWorkers(0),
+      stopping(false)
+{
+    // 0 = un thread par cœur (hardware_concurrency peut retourner 0 s'il ne sait pas)
+    if (numThreads <= 0) {
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Le thread appelant compte comme un thread de calcul : on en crée un de moins
+    for (int i = 1; i < numThreads; i++) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (std::thread& t : workers) {
+        t.join();
+    }
+}
+
+// =========================================================
+// BOUCLE PARALLÈLE
+// =========================================================
+void ThreadPool::parallelFor(int count, int chunkSize, const std::function<void(int, int)>& body) {
+    if (count <= 0) {
+        return;
+    }
+    chunkSize = std::max(1, chunkSize);
+    int chunks = (count + chunkSize - 1) / chunkSize;
+
+    // Repli en série : réveiller les threads coûterait plus cher que le calcul lui-même
+    if (workers.empty() || chunks == 1) {
+        body(0, count);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+
+    // 1. Publication du travail et réveil des threads
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        jobCount = count;
+        jobChunk = chunkSize;
+        numChunks = chunks;
+        nextChunk.store(0);
+        busyWorkers = static_cast<int>(workers.size());
+        generation++;
+    }
+    wakeUp.notify_all();
+
+    // 2. Le thread appelant calcule aussi
+    runChunks();
+
+    // 3. Attente de la fin des autres threads (body ne doit plus être utilisé après le retour)
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]() { return busyWorkers == 0; });
+    job = nullptr;
+}
+
+// =========================================================
+// MÉTHODES PRIVÉES
+// =========================================================
+void ThreadPool::runChunks() {
+    for (;;) {
+        int chunk = nextChunk.fetch_add(1);
+        if (chunk >= numChunks) {
+            return;
+        }
+        int begin = chunk * jobChunk;
+        int end = std::min(begin + jobChunk, jobCount);
+        (*job)(begin, end);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    unsigned long seenGeneration = 0;
+
+    for (;;) {
+        // Attente d'un nouveau travail (ou de l'arrêt)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        runChunks();
+
+        // Signale la fin de ce thread ; le dernier prévient l'appelant
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            busyWorkers--;
+            if (busyWorkers == 0) {
+                finished.notify_one();
+            }
+        }
+    }
+}
+
+// =========================================================
+// GETTERS
+// =========================================================
+
+// Retourne le nombre total de threads de calcul (thread appelant compris)
+int ThreadPool::getThreadCount() const {
+    return static_cast<int>(workers.size()) + 1;
+}
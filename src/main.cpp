@@ -1,20 +1,165 @@
 #include "../include/Simulation.hpp"
+#include "../include/CommandLine.hpp"
 #include <iostream>
+#include <string>
+#include <memory>
+
+// =========================================================
+// LIGNE DE COMMANDE
+// =========================================================
+
+// Affiche les options du programme
+static void printUsage(const char* program) {
+    std::cout << "Utilisation : " << program << " [options]\n"
+              << "  --map <fichier>     Image de la carte (defaut : map.png)\n"
+              << "  --headless          Sans fenetre ni camera, aussi vite que possible\n"
+              << "  --dt <ms>           Pas de temps d'un tick (defaut : 30)\n"
+              << "  --ticks <n>         Arret apres n ticks\n"
+              << "  --until-explored    Arret a la fin de l'exploration\n"
+              << "  --key <tick>:<t>    Touche t au tick donne (ex: 0:2, 15:z, 500:esc)\n"
+              << "  --aruco <tick>:<id> Tag ArUco id vu au tick donne (ex: 0:1)\n"
+              << "  --seed <n>          Graine de la position de depart (defaut : au hasard)\n"
+              << "  --record <fichier>  Enregistre la graine et les entrees de la session\n"
+              << "  --replay <fichier>  Rejoue une session enregistree, sans affichage, et la verifie\n"
+              << "  --grid-log <fichier> Archive l'evolution de la grille (un enregistrement par tick)\n"
+              << "  --help              Affiche cette aide\n"
+              << "Exemple : " << program << " --headless --aruco 0:1 --until-explored --ticks 20000" << std::endl;
+}
+
+// Lit un événement "<tick>:<valeur>" ; isKey : la valeur est une touche (un caractère ou "esc"),
+// sinon un ID de tag ArUco
+static bool parseEvent(const std::string& text, bool isKey, ScriptedEvent& event) {
+    size_t colon = text.find(':');
+    if (colon == std::string::npos || !parseCount(text.substr(0, colon), event.tick)) {
+        return false;
+    }
+    std::string value = text.substr(colon + 1);
+    event.key = -1;
+    event.arucoId = -1;
+    if (!isKey) {
+        return parseCount(value, event.arucoId);
+    }
+    if (value == "esc") {
+        event.key = 27;
+    } else if (value.size() == 1) {
+        event.key = static_cast<unsigned char>(value[0]);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Remplit options depuis argv. Retourne false (avec un message d'erreur) si une option est
+// invalide ; help passe à true si l'aide est demandée.
+static bool parseArguments(int argc, char** argv, SimulationOptions& options, bool& help) {
+    help = false;
+    bool mapGiven = false;
+    std::string replayPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = (i + 1 < argc);
+
+        if (arg == "--help" || arg == "-h") {
+            help = true;
+        } else if (arg == "--headless") {
+            options.headless = true;
+        } else if (arg == "--until-explored") {
+            options.untilExplored = true;
+        } else if (arg == "--map" && hasValue) {
+            options.mapPath = argv[++i];
+            mapGiven = true;
+        } else if (arg == "--record" && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (arg == "--grid-log" && hasValue) {
+            options.gridLogPath = argv[++i];
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = argv[++i];
+        } else if (arg == "--seed" && hasValue) {
+            unsigned seed = 0;
+            if (!parseSeed(argv[++i], seed)) {
+                std::cerr << "ERREUR : --seed attend un nombre de 1 a 4294967295." << std::endl;
+                return false;
+            }
+            options.seed = seed;
+        } else if (arg == "--dt" && hasValue) {
+            if (!parseCount(argv[++i], options.timestepMs) || options.timestepMs == 0) {
+                std::cerr << "ERREUR : --dt attend un nombre de millisecondes > 0." << std::endl;
+                return false;
+            }
+        } else if (arg == "--ticks" && hasValue) {
+            if (!parseCount(argv[++i], options.maxTicks)) {
+                std::cerr << "ERREUR : --ticks attend un nombre de ticks." << std::endl;
+                return false;
+            }
+        } else if ((arg == "--key" || arg == "--aruco") && hasValue) {
+            ScriptedEvent event;
+            if (!parseEvent(argv[++i], arg == "--key", event)) {
+                std::cerr << "ERREUR : " << arg << " attend <tick>:<" << (arg == "--key" ? "touche" : "id")
+                          << ">, pas \"" << argv[i] << "\"." << std::endl;
+                return false;
+            }
+            options.events.push_back(event);
+        } else {
+            std::cerr << "ERREUR : option inconnue ou incomplete \"" << arg << "\"." << std::endl;
+            return false;
+        }
+    }
+
+    // Rejeu : sans affichage, sur la carte de l'enregistrement (sauf --map)
+    if (!replayPath.empty()) {
+        std::shared_ptr<InputLogReader> replay = std::make_shared<InputLogReader>();
+        if (!replay->open(replayPath)) {
+            return false;
+        }
+        if (replay->getTickCount() == 0 && replay->getRecords().empty()) {
+            std::cerr << "ERREUR : Le journal '" << replayPath << "' ne contient aucun tick." << std::endl;
+            return false;
+        }
+        if (!mapGiven) {
+            options.mapPath = replay->getMapPath();
+        }
+        options.headless = true;
+        options.replay = replay;
+        return true;
+    }
+
+    // Sans fenêtre, rien ne permet d'appuyer sur ESC : il faut une condition d'arrêt
+    if (options.headless && options.maxTicks == 0 && !options.untilExplored) {
+        std::cerr << "ERREUR : le mode --headless demande --ticks ou --until-explored." << std::endl;
+        return false;
+    }
+    return true;
+}
 
 // =========================================================
 // POINT D'ENTRÉE DU PROGRAMME
 // =========================================================
-int main() {
+int main(int argc, char** argv) {
+
+    // 0. Lecture des options (sans option : simulation interactive, comme avant)
+    SimulationOptions options;
+    bool help = false;
+    if (!parseArguments(argc, argv, options, help)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (help) {
+        printUsage(argv[0]);
+        return 0;
+    }
     
     // 1. Création de l'instance principale de la simulation.
      // Cela va charger la carte, créer le robot, initialiser la fenêtre, etc.
-    Simulation sim;
+    Simulation sim(options);
         
     // 2. Lancement de la boucle principale.
-    // Cette méthode contient la boucle while(true) et ne rendra la main
-    // que lorsque l'utilisateur appuiera sur ESC ou fermera la fenêtre.
+    // Cette méthode ne rend la main que lorsque l'utilisateur appuie sur ESC
+    // ou qu'une condition d'arrêt des options est atteinte.
     sim.run();
 
-  
+    // En rejeu, le code de retour indique si la session a été reproduite à l'identique
+    if (options.replay && !sim.isReplayIdentical()) {
+        return 2;
+    }
     return 0;
-}
\ No newline at end of file
+}